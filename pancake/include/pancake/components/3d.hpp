@@ -13,10 +13,16 @@ PSTRUCT_MEMBER_INITIALISED(float, fov, 90.f)
 PSTRUCT_MEMBER_INITIALISED(float, near, 0.01f)
 PSTRUCT_MEMBER_INITIALISED(float, far, 1000.f)
 PSTRUCT_MEMBER_INITIALISED(bool, perspective, true)
+// skips instances outside the frustum or hidden behind large opaque occluders
+PSTRUCT_MEMBER_INITIALISED(bool, occlusion_culling, false)
 PSTRUCT_END()
 
 PSTRUCT(MeshInstance)
 PSTRUCT_MEMBER_INITIALISED(GUID, mesh, GUID::null)
 PSTRUCT_MEMBER_INITIALISED(CameraMask, camera_mask, CameraMask().with(0))
 PSTRUCT_END()
+
+// mesh instances that never move, merged with their neighbours by DrawStaticMeshes
+PSTRUCT(StaticMesh)
+PSTRUCT_END()
 }  // namespace pancake
\ No newline at end of file
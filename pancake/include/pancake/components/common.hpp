@@ -18,4 +18,11 @@ PSTRUCT_MEMBER_INITIALISED(int, tile, -1);
 
 auto operator<=>(const TextureRef&) const = default;
 PSTRUCT_END()
-}  // namespace pancake
\ No newline at end of file
+}  // namespace pancake
+
+template <>
+struct std::hash<pancake::TextureRef> {
+  size_t operator()(const pancake::TextureRef& ref) const noexcept {
+    return std::hash<pancake::GUID>{}(ref.texture) ^ (std::hash<int>{}(ref.tile) << 1);
+  }
+};
\ No newline at end of file
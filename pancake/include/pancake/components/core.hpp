@@ -30,5 +30,8 @@ PSTRUCT_MEMBER_INITIALISED(int, blit_priority, -1)
 PSTRUCT_MEMBER_INITIALISED(char, num_targets, 1)
 PSTRUCT_MEMBER_INITIALISED(bool, auto_clear, true)
 PSTRUCT_MEMBER_INITIALISED(bool, depth_test, true)
+// contents only last the frame, so the target may be shared with others of the same layout and
+// skipped entirely when nothing reads it
+PSTRUCT_MEMBER_INITIALISED(bool, transient, false)
 PSTRUCT_END()
 }  // namespace pancake
\ No newline at end of file
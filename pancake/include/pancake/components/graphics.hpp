@@ -12,5 +12,6 @@ PSTRUCT_END()
 
 PSTRUCT(PointLight)
 PSTRUCT_MEMBER_INITIALISED(Vec4f, color, Vec4f::ones())
+PSTRUCT_MEMBER_INITIALISED(float, radius, 0.f)
 PSTRUCT_END()
 }  // namespace pancake
\ No newline at end of file
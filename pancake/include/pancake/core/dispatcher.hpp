@@ -4,8 +4,10 @@
 #include "util/containers.hpp"
 
 #include <atomic>
+#include <functional>
 #include <mutex>
 #include <queue>
+#include <span>
 #include <thread>
 #include <vector>
 
@@ -17,8 +19,12 @@ class Dispatcher {
 
   void execute(SystemGraph& system_graph);
 
+  // runs every task across the thread pool and the calling thread, returning once all are done
+  void execute(std::span<const std::function<void()>> tasks);
+
  private:
   void consumeSystems();
+  void consumeTasks();
 
   bool _online;
 
@@ -30,6 +36,11 @@ class Dispatcher {
 
   std::atomic_size_t _num_done;
 
+  std::span<const std::function<void()>> _tasks;
+  size_t _next_task;
+  std::mutex _task_mutex;
+  std::atomic_size_t _num_tasks_done;
+
   std::vector<std::thread> _thread_pool;
 };
 }  // namespace pancake
\ No newline at end of file
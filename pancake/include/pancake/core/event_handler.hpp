@@ -2,13 +2,14 @@
 
 namespace pancake {
 class Session;
+class SessionConfig;
 class EventHandler {
  public:
   virtual ~EventHandler() = default;
 
   virtual bool handleEvents(Session& session) = 0;
 
-  static EventHandler* create();
+  static EventHandler* create(const SessionConfig& config);
 
  protected:
   EventHandler() = default;
@@ -11,6 +11,7 @@
 
 namespace pancake {
 class Gamepad;
+class SessionConfig;
 class Input {
  public:
   virtual ~Input();
@@ -45,7 +46,7 @@ class Input {
   InputAxis& getOrCreateAxis(std::string_view name);
   const InputAxis& getAxis(std::string_view name) const;
 
-  static Input* create();
+  static Input* create(const SessionConfig& config);
 
  protected:
   Input() = default;
@@ -5,39 +5,45 @@
 #include "components/core.hpp"
 #include "graphics/common.hpp"
 #include "graphics/draw_options.hpp"
+#include "graphics/draw_queue.hpp"
+#include "graphics/dynamic_resolution.hpp"
 #include "graphics/framebuffer.hpp"
 #include "graphics/light_info.hpp"
 #include "graphics/material.hpp"
+#include "graphics/occlusion_buffer.hpp"
 #include "graphics/shader_input.hpp"
 #include "graphics/texture.hpp"
 #include "graphics/tileset.hpp"
+#include "graphics/uniform_buffer.hpp"
+#include "graphics/vertex.hpp"
+#include "graphics/vertex_layout.hpp"
 #include "pancake.hpp"
 #include "util/matrix.hpp"
 
+#include <array>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <span>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace pancake {
 class AtlassedTexture;
+class Dispatcher;
 class GUID;
 class Mesh;
 class Session;
+class SessionConfig;
 class Shader;
-struct Vertex;
 class Resources;
 class TextResource;
 class TexturePropsResource;
 
-struct CommonPerInstanceData {
-  Mat4f mvp_transform = Mat4f::ones();
-  Mat4f model_transform = Mat4f::ones();
-  Entity entity = Entity::null;
-};
-
 class Renderer {
  public:
   Renderer();
@@ -47,6 +53,7 @@ class Renderer {
 
   void queueMeshUpdate(const GUID& guid);
   void queueTextureUpdate(const GUID& guid);
+  void queueTextureUpdate(const TextureRef& texture);
   void queueTilesetUpdate(const GUID& guid);
   void queueShaderUpdate(const GUID& guid);
 
@@ -57,12 +64,30 @@ class Renderer {
 
   std::optional<Ptr<Texture>> getTexturePtr(const GUID& guid);
 
+  // resolves framebuffer targets and tileset tiles, falling back to the blank texture. transform
+  // receives the uv offset and scale to sample the texture or tile with
+  const Texture& resolveTexture(const TextureRef& texture, Vec4f& transform) const;
+
   void setScreenSize(const Vec2i& size);
   void matchRenderSizeToScreenSize(bool value);
 
   const Vec2i& renderSize() const;
   const Vec2i& screenSize() const;
 
+  // scales the main framebuffer, and those sized relative to it, to keep gpu frame time under
+  // target_milliseconds. input and ui carry on working in renderSize() units
+  void enableDynamicResolution(double target_milliseconds,
+                               float min_scale = 0.5f,
+                               float max_scale = 1.f);
+  void disableDynamicResolution();
+
+  float renderScale() const;
+  // renderSize() at the current render scale, the size the main framebuffer is drawn at
+  Vec2i scaledRenderSize() const;
+  // size ui on a framebuffer is laid out at, framebuffers sized relative to the render size follow
+  // the unscaled one so layouts hold still while the render scale changes
+  Vec2i layoutSize(const FramebufferInfo& framebuffer_info) const;
+
   Vec2f screenToRenderPosition(const Vec2f& screen_pos) const;
 
   void submitFramebuffer(const GUID& guid, const FramebufferInfo& framebuffer_info);
@@ -71,6 +96,8 @@ class Renderer {
   void submitMaterial(const GUID& guid, Resources& resources);
   void submitLight(const LightInfo& light_info);
 
+  // the submit functions are safe to call concurrently, each thread fills its own buffer which
+  // preRender merges
   void submit(const CameraMask& mask,
               const GUID& material,
               const std::set<ShaderInput>& input_overrides,
@@ -78,6 +105,46 @@ class Renderer {
               const Mat4f& model,
               const Entity& entity = Entity::null);
 
+  void submit(const CameraMask& mask,
+              const GUID& material,
+              const Ptr<const ShaderInputBlock>& input_overrides,
+              const GUID& mesh,
+              const Mat4f& model,
+              const Entity& entity = Entity::null);
+
+  // retained draws persist across frames until released. resubmitting one with only a new model,
+  // entity or instance data patches it in place, any other change re-queues every retained draw
+  void submitRetained(const GUID& id,
+                      const CameraMask& mask,
+                      const GUID& material,
+                      const Ptr<const ShaderInputBlock>& input_overrides,
+                      const GUID& mesh,
+                      const Mat4f& model,
+                      const Entity& entity = Entity::null);
+  void submitRetained(const GUID& id,
+                      int stage,
+                      const GUID& framebuffer,
+                      const DrawOptions& options,
+                      const GUID& shader,
+                      const Ptr<const ShaderInputBlock>& inputs,
+                      const GUID& mesh,
+                      const CommonPerInstanceData& cpid);
+  void submitRetainedRelease(const GUID& id);
+
+  // creates or replaces a mesh that isn't backed by a resource, applied before the frame is drawn
+  void submitMeshUpdate(const GUID& guid,
+                        std::vector<Vertex> vertices,
+                        std::vector<unsigned int> indices,
+                        const VertexLayout& layout = VertexLayout::full());
+  void submitMeshRelease(const GUID& guid);
+
+  // sprites take the default material's stage and uniforms, but are drawn with the sprite shader
+  // from compact instances, with uvs resolved on the cpu
+  void submitSprite(const CameraMask& mask,
+                    const TextureRef& texture,
+                    const Transform2D& transform,
+                    uint32_t colour = 0xFFFFFFFF);
+
   void submit(int stage,
               const GUID& framebuffer,
               const DrawOptions& options,
@@ -86,11 +153,20 @@ class Renderer {
               const GUID& mesh,
               const CommonPerInstanceData& cpid);
 
+  void submit(int stage,
+              const GUID& framebuffer,
+              const DrawOptions& options,
+              const GUID& shader,
+              const Ptr<const ShaderInputBlock>& inputs,
+              const GUID& mesh,
+              const CommonPerInstanceData& cpid);
+
   virtual int bindTexture(const Texture& texture) = 0;
 
   virtual const Texture& getBlankTexture() const = 0;
   virtual Ptr<Mesh> getUnitSquare() const = 0;
   virtual Ptr<Shader> getDefaultShader() const = 0;
+  virtual Ptr<Shader> getSpriteShader() const = 0;
 
   void drawDebugLine(const Vec2f& a, const Vec2f& b, const CameraMask& mask);
   void drawDebugRect(const Vec2f& a, const Vec2f& b, const CameraMask& mask);
@@ -98,7 +174,7 @@ class Renderer {
   virtual void preRender(Session& session, Resources& resources);
   virtual void render();
 
-  static Renderer* create(Resources& resources);
+  static Renderer* create(const SessionConfig& config, Resources& resources);
 
  protected:
   virtual Texture* createTexture(const TexturePropsResource& texture_props) = 0;
@@ -110,24 +186,95 @@ class Renderer {
                                            std::span<const Vertex> vertices,
                                            std::span<const unsigned int> indices) = 0;
   virtual std::unique_ptr<Shader> createShader(const ShaderResourceInterface& res) = 0;
+  virtual std::unique_ptr<UniformBuffer> createUniformBuffer() = 0;
+
+  virtual size_t uniformBufferOffsetAlignment() const = 0;
 
   virtual void useDrawOptions(const DrawOptions& options) = 0;
 
+  // called once per frame with every queued instance, before any drawMeshInstances
+  virtual void uploadInstances(std::span<const CommonPerInstanceData> cpids) = 0;
+  virtual void uploadSpriteInstances(std::span<const SpriteInstanceData> sprites) = 0;
+
   virtual void drawMeshInstances(const Mesh& mesh,
+                                 uint32_t lod,
                                  std::span<const CommonPerInstanceData> cpids) = 0;
+  virtual void drawSpriteInstances(std::span<const SpriteInstanceData> sprites) = 0;
 
   virtual void copyToScreen(Framebuffer& framebuffer) = 0;
   virtual void blit(Framebuffer& dst, const Framebuffer& src) = 0;
 
+  // brackets a section of the frame for gpu timing. sections don't nest, beginning one ends the
+  // previous
+  virtual void beginGPUTimer(std::string name) = 0;
+  virtual void endGPUTimer() = 0;
+
   std::unordered_map<GUID, Ptr<Texture>> _textures;
   std::unordered_map<GUID, Ptr<Mesh>> _meshes;
   std::unordered_map<GUID, Ptr<Shader>> _shaders;
   std::unordered_map<GUID, Material> _materials;
 
  private:
+  struct CameraSubmission {
+    CameraMask mask;
+    GUID material;
+    Ptr<const ShaderInputBlock> input_overrides;
+    GUID mesh;
+    Mat4f model;
+    Entity entity;
+  };
+
+  struct DrawSubmission {
+    int stage;
+    GUID framebuffer;
+    DrawOptions options;
+    GUID shader;
+    Ptr<const ShaderInputBlock> inputs;
+    GUID mesh;
+    CommonPerInstanceData cpid;
+  };
+
+  struct SpriteSubmission {
+    CameraMask mask;
+    TextureRef texture;
+    SpriteInstanceData sprite;
+  };
+
+  struct MeshSubmission {
+    GUID guid;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    VertexLayout layout;
+  };
+
+  struct SubmissionBuffer {
+    std::vector<CameraSubmission> cam_draw_calls;
+    std::vector<DrawSubmission> draw_calls;
+    std::vector<std::pair<GUID, CameraSubmission>> retained_cam_draw_calls;
+    std::vector<std::pair<GUID, DrawSubmission>> retained_draw_calls;
+    std::vector<GUID> retained_releases;
+    std::vector<SpriteSubmission> sprite_calls;
+    std::vector<MeshSubmission> mesh_updates;
+    std::vector<GUID> mesh_releases;
+  };
+
+  SubmissionBuffer& submissionBuffer();
+  void mergeSubmissionBuffers();
+  void queueRetained(Dispatcher& dispatcher);
+  void queueSprites();
+
+  void bindCameraUniforms(Shader& shader, uint32_t camera, const Material* material);
+  void bindMaterialUniforms(Shader& shader, Material& material);
+
   Vec2i _render_size;
   Vec2i _screen_size;
   bool _render_match_screen;
+  std::optional<DynamicResolution> _dynamic_resolution;
+  float _render_scale;
+
+  uint64_t _id;
+  std::mutex _submission_buffers_mutex;
+  std::vector<std::unique_ptr<SubmissionBuffer>> _submission_buffers;
 
   std::set<GUID> _mesh_update_queue;
   std::vector<GUID> _texture_update_queue;
@@ -136,7 +283,30 @@ class Renderer {
 
   std::unordered_map<GUID, Tileset> _tilesets;
 
-  std::unordered_map<GUID, std::unique_ptr<Framebuffer>> _framebuffers;
+  // a pass is every draw into one framebuffer this frame, in sorted batch order
+  struct FramebufferPass {
+    uint32_t first_batch = std::numeric_limits<uint32_t>::max();
+    uint32_t last_batch = 0;
+    bool written = false;
+    bool live = false;
+    bool begun = false;
+    std::vector<GUID> reads;
+  };
+
+  struct PooledFramebuffer {
+    Ptr<Framebuffer> framebuffer;
+    uint32_t idle_frames;
+  };
+
+  Ptr<Framebuffer> acquireFramebuffer(const GUID& guid, const FramebufferInfo& info);
+  void releaseFramebuffer(Ptr<Framebuffer> framebuffer);
+  void planFramebuffers();
+
+  // transient framebuffers alias one another, so several guids can map to the same framebuffer
+  std::unordered_map<GUID, Ptr<Framebuffer>> _framebuffers;
+  std::unordered_map<GUID, FramebufferInfo> _framebuffer_infos;
+  std::unordered_map<GUID, FramebufferPass> _framebuffer_passes;
+  std::vector<PooledFramebuffer> _framebuffer_pool;
   std::set<std::pair<int, GUID>> _blitting_framebuffers;
 
   std::vector<LightInfo> _lights;
@@ -151,27 +321,180 @@ class Renderer {
     float far;
     float fov;
     bool perspective;
+    bool occlusion_culling;
 
     Mat4f projection(const Framebuffer& framebuffer) const;
   };
 
   std::vector<CameraInfo> _cameras;
-  std::map<
-      CameraMask,
-      std::unordered_map<
-          GUID /* MATERIAL */,
-          std::map<std::set<ShaderInput>,
-                   std::unordered_map<GUID /* MESH */, std::vector<std::pair<Mat4f, Entity>>>>>>
-      _cam_draw_calls;
-  std::map<
-      int /* STAGE */,
-      std::map<GUID /* FRAMEBUFFER */,
-               std::map<DrawOptions,
-                        std::unordered_map<
-                            GUID /* SHADER */,
-                            std::map<std::set<ShaderInput>,
-                                     std::unordered_map<GUID /* MESH */,
-                                                        std::vector<CommonPerInstanceData>>>>>>>
-      _draw_calls;
+
+  struct CameraDrawCall {
+    CameraMask mask;
+    uint32_t material;
+    uint32_t input_overrides;
+    GUID mesh;
+    Mat4f model;
+    Entity entity;
+  };
+
+  struct RetainedCameraCall {
+    CameraSubmission call;
+    std::vector<uint32_t> packets;
+  };
+
+  struct RetainedDrawCall {
+    DrawSubmission call;
+    uint32_t packet;
+  };
+
+  // everything a retained camera draw's queued packets depend on besides the draw itself, where
+  // the camera looks from only changes their instances
+  struct RetainedCamera {
+    GUID fb;
+    CameraMask mask;
+    bool drawn;
+
+    bool operator==(const RetainedCamera& rhs) const = default;
+  };
+
+  struct RetainedMaterial {
+    bool loaded = false;
+    GUID shader = GUID::null;
+    int stage = 0;
+    bool depth_test = false;
+    bool binned_lights = false;
+    std::string light_pass_input_name;
+    std::vector<ShaderInput> texture_inputs;
+
+    bool operator==(const RetainedMaterial& rhs) const = default;
+  };
+
+  // a camera's draw calls from a range of runs, expanded by one task of the dispatcher
+  struct CameraTask {
+    uint32_t camera;
+    uint32_t first_run;
+    uint32_t last_run;
+  };
+
+  // consecutive packets from one run that share everything but their mesh and instance
+  struct CameraPacketGroup {
+    int stage;
+    DrawOptions options;
+    GUID shader;
+    Ptr<const ShaderInputBlock> inputs;
+    GUID material;
+    uint32_t num_packets;
+  };
+
+  // written by a single task, then merged into the draw queue
+  struct CameraPackets {
+    std::vector<CameraPacketGroup> groups;
+    std::vector<uint32_t> calls;
+    std::vector<CommonPerInstanceData> cpids;
+    std::vector<uint32_t> lods;
+  };
+
+  // level of detail to draw an instance of mesh at, as seen from camera
+  uint32_t selectLod(const Mesh* mesh, uint32_t camera, const Mat4f& mvp, const Mat4f& model) const;
+
+  void expandCameraDrawCalls(std::span<const CameraDrawCall> calls,
+                             const SlotTable<GUID>& materials,
+                             const CameraTask& task,
+                             CameraPackets& packets) const;
+  // each run's input overrides merged with its material's texture inputs, and each light's for
+  // unbinned light passes
+  void internCameraRunInputs(std::span<const CameraDrawCall> calls,
+                             const SlotTable<GUID>& materials,
+                             const ShaderInputsSlotTable& input_overrides,
+                             uint32_t num_runs);
+  void queueCameraDrawCalls(Dispatcher& dispatcher,
+                            std::span<const CameraDrawCall> calls,
+                            const SlotTable<GUID>& materials,
+                            const ShaderInputsSlotTable& input_overrides,
+                            std::span<RetainedCameraCall* const> retained);
+  RetainedMaterial retainedMaterial(const GUID& guid);
+  // whether a material still expands exactly as it did when the retained packets were queued
+  bool retainedMaterialMatches(const GUID& guid, const RetainedMaterial& state) const;
+  // patches moved retained draws, and every retained camera draw once a camera has moved
+  void patchRetained();
+
+  std::vector<CameraDrawCall> _cam_draw_calls;
+  std::vector<DrawSubmission> _draw_calls;
+  std::vector<SortKey> _cam_draw_keys;
+  std::vector<SortKey> _cam_draw_scratch;
+  std::vector<uint32_t> _cam_draw_runs;
+  // the interned blocks of run r are _cam_run_inputs[_cam_run_blocks[r], _cam_run_blocks[r + 1])
+  std::vector<Ptr<const ShaderInputBlock>> _cam_run_inputs;
+  std::vector<uint32_t> _cam_run_blocks;
+  std::vector<CameraTask> _cam_tasks;
+  std::vector<CameraPackets> _cam_packets;
+  SlotTable<GUID> _cam_materials;
+  ShaderInputsSlotTable _cam_input_overrides;
+  std::vector<Mat4f> _camera_view_projections;
+  // pixels per unit at a clip space w of 1, for picking levels of detail
+  std::vector<float> _camera_lod_scales;
+
+  std::unordered_map<GUID, RetainedCameraCall> _retained_cam_calls;
+  std::unordered_map<GUID, RetainedDrawCall> _retained_draw_calls;
+  std::vector<GUID> _retained_patches;
+  bool _retained_dirty = false;
+  bool _retained_lods_dirty = false;
+
+  std::vector<CameraDrawCall> _retained_cam_draw_calls;
+  std::vector<RetainedCameraCall*> _retained_cam_order;
+  SlotTable<GUID> _retained_cam_materials;
+  ShaderInputsSlotTable _retained_cam_input_overrides;
+  std::vector<RetainedCamera> _retained_cameras;
+  std::vector<Mat4f> _retained_view_projections;
+  std::vector<float> _retained_lod_scales;
+  std::vector<RetainedMaterial> _retained_materials;
+  std::vector<LightInfo> _retained_lights;
+
+  struct SpriteCall {
+    CameraMask mask;
+    uint32_t texture;
+    SpriteInstanceData sprite;
+  };
+
+  std::vector<SpriteCall> _sprite_calls;
+  SlotTable<TextureRef> _sprite_textures;
+  std::vector<Ptr<const ShaderInputBlock>> _sprite_texture_inputs;
+  std::vector<std::array<uint16_t, 4>> _sprite_uv_rects;
+  std::unordered_map<GUID, Ptr<const ShaderInputBlock>> _sprite_atlas_inputs;
+
+  DrawQueue _draw_queue;
+
+  struct OccluderCandidate {
+    float coverage;
+    uint32_t camera;
+    const Mesh* mesh;
+    const CommonPerInstanceData* cpid;
+  };
+
+  // drops sorted instances that cameras with occlusion culling can't see. batches keep their
+  // order, so framebuffer passes planned from the draw queue still line up
+  void cullInstances();
+
+  // occluders smaller than this fraction of the screen are left out of the occlusion buffer
+  static constexpr float MIN_OCCLUDER_COVERAGE = 0.01f;
+  static constexpr size_t MAX_CAMERA_OCCLUDER_TRIANGLES = 1 << 15;
+
+  std::vector<OcclusionBuffer> _occlusion_buffers;
+  std::vector<OccluderCandidate> _occluder_candidates;
+  std::vector<DrawQueue::Batch> _culled_batches;
+  std::vector<CommonPerInstanceData> _culled_instances;
+  bool _culled = false;
+
+  float _time;
+  std::unique_ptr<UniformBuffer> _frame_uniform_buffer;
+  std::unique_ptr<UniformBuffer> _camera_uniform_buffer;
+  std::vector<CameraUniforms> _camera_uniforms;
+  std::vector<std::byte> _camera_uniform_data;
+  size_t _camera_uniform_stride;
+
+  std::unique_ptr<UniformBuffer> _light_uniform_buffer;
+  std::vector<LightUniforms> _light_uniforms;
+  std::vector<std::byte> _light_uniform_data;
+  size_t _light_uniform_stride;
 };
 }  // namespace pancake
\ No newline at end of file
@@ -33,6 +33,7 @@ class Session {
   MessageBoards& globalMessages();
   Renderer& renderer();
   Resources& resources();
+  Dispatcher& dispatcher();
 
   float delta() const;
   float time() const;
@@ -59,6 +60,8 @@ class Session {
 
   Dispatcher _dispatcher;
 
+  Ptr<Systems> _logic_systems;
+  Ptr<Systems> _draw_systems;
   SystemGraph _logic_system_graph;
   SystemGraph _draw_system_graph;
 
@@ -9,12 +9,15 @@ class SessionAccess {
 
   SessionAccess& addImGui();
   SessionAccess& addRenderer();
+  // shared renderer access, only for submitting draws and reading fixed renderer state
+  SessionAccess& addRendererSubmit();
   SessionAccess& addResources();
 
   bool intersects(const SessionAccess& other) const;
 
   bool hasImGuiAccess() const;
   bool hasRendererAccess() const;
+  bool hasRendererSubmitAccess() const;
   bool hasResourcesAccess() const;
 
   SessionAccess operator&(const SessionAccess& rhs) const;
@@ -25,6 +28,7 @@ class SessionAccess {
  private:
   bool _imGui;
   bool _renderer;
+  bool _renderer_submit;
   bool _resources;
 };
 }  // namespace pancake
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "util/containers.hpp"
 #include "util/type_id.hpp"
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <set>
@@ -101,4 +102,45 @@ class ResourcePathsRule : public SessionConfigRule {
  private:
   std::vector<std::string> _resource_paths;
 };
+
+class HeadlessRule : public SessionConfigRule {
+ public:
+  virtual ~HeadlessRule() = default;
+  virtual void operator()(CmdLineOptions& options, std::string_view option) override;
+  virtual const std::set<std::string>& getOptions() const override;
+  bool value() const;
+
+  // fixed steps to run before quitting, 0 runs until something else quits
+  uint64_t frames() const;
+
+ private:
+  bool _value = false;
+  uint64_t _frames = 0;
+};
+
+// scales the render size to hold the given frame rate on the gpu
+class DynamicResolutionRule : public SessionConfigRule {
+ public:
+  virtual ~DynamicResolutionRule() = default;
+  virtual void operator()(CmdLineOptions& options, std::string_view option) override;
+  virtual const std::set<std::string>& getOptions() const override;
+
+  // 0 leaves the render size alone
+  double frameRate() const;
+
+ private:
+  double _frame_rate = 0.0;
+};
+
+// shows cpu and gpu timings in an imgui window, when imgui is enabled
+class ShowProfilerRule : public SessionConfigRule {
+ public:
+  virtual ~ShowProfilerRule() = default;
+  virtual void operator()(CmdLineOptions& options, std::string_view option) override;
+  virtual const std::set<std::string>& getOptions() const override;
+  bool value() const;
+
+ private:
+  bool _value = false;
+};
 }  // namespace pancake
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "util/matrix.hpp"
 
 namespace pancake {
+class SessionConfig;
 class Window {
  public:
   virtual ~Window() = default;
@@ -12,7 +13,7 @@ class Window {
 
   virtual Vec2i size() const = 0;
 
-  static Window* create();
+  static Window* create(const SessionConfig& config);
 
  protected:
   Window() = default;
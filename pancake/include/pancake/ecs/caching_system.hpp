@@ -20,6 +20,8 @@ class CachingSystem : public Parent {
 
   virtual void _run(const SessionWrapper& session, Cache& cache) const {}
   virtual void _run(const SessionWrapper& session, const WorldWrapper& world, Cache& cache) const {}
+  // releases whatever a world's cache still has submitted, before the cache is dropped
+  virtual void _releaseCache(Session& session, Cache& cache) const {}
 
   virtual void _configure(Session& session) override final {
     static_assert(std::is_base_of_v<System, Parent>);
@@ -33,6 +35,13 @@ class CachingSystem : public Parent {
     }
   }
 
+  virtual void _removeWorld(Session& session, const World& world) override final {
+    if (const auto it = _caches.find(&world); it != _caches.end()) {
+      _releaseCache(session, it->second);
+      _caches.erase(it);
+    }
+  }
+
   virtual void _run(const SessionWrapper& session) const override final {
     _run(session, _caches.at(nullptr));
   }
@@ -28,6 +28,8 @@ class System {
   virtual ~System() = default;
 
   void configure();
+  // drops anything kept for a world the session no longer has
+  void removeWorld(const World& world);
   void run(SystemNodeId system_node) const;
   void run(World& world, SystemNodeId system_node) const;
 
@@ -55,6 +57,7 @@ class System {
   System(Session& session);
 
   virtual void _configure(Session& session);
+  virtual void _removeWorld(Session& session, const World& world);
   virtual void _run(const SessionWrapper& session) const;
   virtual void _run(const SessionWrapper& session, const WorldWrapper& world) const;
 
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pancake {
+// GL_TIME_ELAPSED queries around named sections of a frame, pooled across the frames in flight.
+// results are only read once available and reported to the profiler, so timing never stalls
+class GL3GPUTimer {
+ public:
+  static constexpr size_t FRAMES_IN_FLIGHT = 3;
+
+  GL3GPUTimer();
+  ~GL3GPUTimer();
+
+  // sections can't nest, beginning one ends whichever is open
+  void begin(std::string name);
+  void end();
+
+  // reports every earlier frame whose results have arrived, then moves on to the next frame
+  void endFrame();
+
+ private:
+  struct Frame {
+    std::vector<unsigned int> queries;
+    std::vector<std::string> names;
+    size_t used = 0;
+    bool pending = false;
+    uint64_t id = 0;
+  };
+
+  bool collect(Frame& frame);
+
+  std::array<Frame, FRAMES_IN_FLIGHT> _frames;
+  size_t _frame_index;
+  // counts measured frames, so each one collected is a separate profiler sample
+  uint64_t _frame_id;
+  bool _open;
+  size_t _dropped_frames;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -1,32 +1,50 @@
 #pragma once
 
 #include "graphics/mesh.hpp"
+#include "pancake.hpp"
 
 #include <span>
+#include <vector>
 
 namespace pancake {
 class GL3Renderer;
+class GL3UploadQueue;
 class GL3Mesh : public Mesh {
  public:
   virtual ~GL3Mesh();
 
   virtual void update(std::span<const Vertex> vertices,
-                      std::span<const unsigned int> indices) override;
-  virtual void draw(unsigned int num_instances = 1) const override;
+                      std::span<const unsigned int> indices,
+                      const VertexLayout& layout = VertexLayout::full(),
+                      std::span<const unsigned int> lod_indices = {},
+                      std::span<const MeshLod> lods = {}) override;
+  virtual void draw(unsigned int num_instances = 1,
+                    unsigned int first_instance = 0,
+                    uint32_t lod = 0) const override;
 
  private:
-  GL3Mesh(const GUID& guid, unsigned int instance_vbo);
+  GL3Mesh(const GUID& guid, unsigned int instance_vbo, Ptr<GL3UploadQueue> upload_queue);
   GL3Mesh(const GUID& guid,
           std::span<const Vertex> vertices,
           std::span<const unsigned int> indices,
-          unsigned int instance_vbo);
+          unsigned int instance_vbo,
+          Ptr<GL3UploadQueue> upload_queue);
+
+  void createBuffers();
 
   friend GL3Renderer;
 
   unsigned int _vao;
   unsigned int _vbo;
   unsigned int _ebo;
+  VertexLayout _layout;
+  size_t _vertex_capacity;
+  size_t _index_capacity;
   unsigned int _num_indices;
+  std::vector<MeshLod> _uploaded_lods;
+  unsigned int _index_type;
   unsigned int _instance_vbo;
+  Ptr<GL3UploadQueue> _upload_queue;
+  mutable unsigned int _attrib_first_instance;
 };
 }  // namespace pancake
\ No newline at end of file
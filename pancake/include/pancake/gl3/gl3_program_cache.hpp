@@ -0,0 +1,40 @@
+#pragma once
+
+#include "util/guid.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace pancake {
+// linked program binaries on disk, one per shader, keyed by a hash of the shader's sources and the
+// driver that linked them. a shader whose key still matches skips compiling and linking entirely
+class GL3ProgramCache {
+ public:
+  static GL3ProgramCache& get();
+
+  // links program from the shader's cached binary, false if it is missing, stale or rejected
+  bool load(const GUID& shader,
+            unsigned int program,
+            std::string_view vert_source,
+            std::string_view frag_source);
+
+  // must be called before linking a program that will be stored
+  void prepare(unsigned int program) const;
+  void store(const GUID& shader,
+             unsigned int program,
+             std::string_view vert_source,
+             std::string_view frag_source);
+
+ private:
+  GL3ProgramCache();
+
+  uint64_t key(std::string_view vert_source, std::string_view frag_source) const;
+  std::filesystem::path path(const GUID& shader) const;
+
+  bool _enabled;
+  std::string _driver;
+  std::filesystem::path _directory;
+};
+}  // namespace pancake
\ No newline at end of file
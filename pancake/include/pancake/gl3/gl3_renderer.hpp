@@ -15,9 +15,11 @@
 namespace pancake {
 class AtlassedTexture;
 class ImageAtlas;
+class GL3GPUTimer;
 class GL3Mesh;
 class GL3Shader;
 class GL3Texture;
+class GL3UploadQueue;
 class GL3Renderer : public Renderer {
  public:
   GL3Renderer(Resources& resources);
@@ -28,13 +30,16 @@ class GL3Renderer : public Renderer {
   virtual const Texture& getBlankTexture() const override;
   virtual Ptr<Mesh> getUnitSquare() const override;
   virtual Ptr<Shader> getDefaultShader() const override;
+  virtual Ptr<Shader> getSpriteShader() const override;
 
   virtual void preRender(Session& session, Resources& resources) override;
   virtual void render() override;
 
  protected:
   virtual void drawMeshInstances(const Mesh& mesh,
+                                 uint32_t lod,
                                  std::span<const CommonPerInstanceData> cpids) override;
+  virtual void drawSpriteInstances(std::span<const SpriteInstanceData> sprites) override;
 
   virtual Texture* createTexture(const TexturePropsResource& texture_props) override;
   virtual std::unique_ptr<Framebuffer> createFramebuffer(const GUID& guid,
@@ -45,12 +50,21 @@ class GL3Renderer : public Renderer {
                                            std::span<const Vertex> vertices,
                                            std::span<const unsigned int> indices) override;
   virtual std::unique_ptr<Shader> createShader(const ShaderResourceInterface& res) override;
+  virtual std::unique_ptr<UniformBuffer> createUniformBuffer() override;
+
+  virtual size_t uniformBufferOffsetAlignment() const override;
 
   virtual void useDrawOptions(const DrawOptions& options) override;
 
+  virtual void uploadInstances(std::span<const CommonPerInstanceData> cpids) override;
+  virtual void uploadSpriteInstances(std::span<const SpriteInstanceData> sprites) override;
+
   virtual void copyToScreen(Framebuffer& framebuffer) override;
   virtual void blit(Framebuffer& dst, const Framebuffer& src) override;
 
+  virtual void beginGPUTimer(std::string name) override;
+  virtual void endGPUTimer() override;
+
  private:
   struct AtlasInfo {
     Ptr<TexturePropsResource> props;
@@ -62,10 +76,34 @@ class GL3Renderer : public Renderer {
 
   AtlasInfo createAtlas(BufferFormat format, TextureFilter filter);
 
+  unsigned int streamInstances(std::span<const CommonPerInstanceData> cpids);
+  unsigned int streamSprites(std::span<const SpriteInstanceData> sprites);
+
+  Resources& _resources;
+  Ptr<GL3UploadQueue> _upload_queue;
+  Ptr<GL3GPUTimer> _gpu_timer;
+
   unsigned int _instance_vbo;
+  size_t _instance_capacity;
+  size_t _instance_offset;
+  std::span<const CommonPerInstanceData> _frame_instances;
+  unsigned int _frame_first_instance;
+
+  unsigned int _sprite_vao;
+  unsigned int _sprite_vbo;
+  size_t _sprite_capacity;
+  size_t _sprite_offset;
+  std::span<const SpriteInstanceData> _frame_sprites;
+  unsigned int _frame_first_sprite;
+  unsigned int _sprite_attrib_first_instance;
+  GUID _sprite_shader;
+
   std::vector<AtlasInfo> _atlas_infos;
 
-  int _next_texture_slot;
+  // slots are handed out least recently used first, so a draw never evicts its own textures
+  uint64_t _texture_slot_clock;
   std::vector<GUID> _texture_slots;
+  std::vector<uint64_t> _texture_slot_last_use;
+  std::unordered_map<GUID, int> _texture_slot_lookup;
 };
 }  // namespace pancake
\ No newline at end of file
@@ -5,7 +5,9 @@
 #include "pancake.hpp"
 #include "util/guid.hpp"
 
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace pancake {
 class GL3Renderer;
@@ -14,26 +16,37 @@ class GL3Shader : public Shader {
  public:
   virtual ~GL3Shader();
 
-  virtual void compileVertexSource(std::string_view source) override;
-  virtual void compileFragmentSource(std::string_view source) override;
+  // sources are only compiled when linking finds no cached program binary for them
+  virtual void setVertexSource(std::string_view source) override;
+  virtual void setFragmentSource(std::string_view source) override;
   virtual void linkProgram() override;
 
   virtual void use() const override;
 
-  virtual void setUniform(std::string_view name, int value) const override;
-  virtual void setUniform(std::string_view name, float value) const override;
-  virtual void setUniform(std::string_view name, const Vec3f& value) const override;
-  virtual void setUniform(std::string_view name, const Vec4f& value) const override;
-  virtual void setUniform(std::string_view name, const Vec4u& value) const override;
-  virtual void setUniform(std::string_view name, const Mat4f& value) const override;
+  virtual void setUniform(const UniformId& id, int value) const override;
+  virtual void setUniform(const UniformId& id, float value) const override;
+  virtual void setUniform(const UniformId& id, const Vec3f& value) const override;
+  virtual void setUniform(const UniformId& id, const Vec4f& value) const override;
+  virtual void setUniform(const UniformId& id, const Vec4u& value) const override;
+  virtual void setUniform(const UniformId& id, const Mat4f& value) const override;
+
+  virtual const UniformBlockLayout* getUniformBlockLayout(UniformBlock block) const override;
 
  private:
   GL3Shader(const ShaderResourceInterface& res);
 
+  int uniformLocation(const UniformId& id) const;
+  void reflectUniformBlocks();
+
   friend GL3Renderer;
 
   unsigned int _vert_shader;
   unsigned int _frag_shader;
   unsigned int _program;
+  std::string _vert_source;
+  std::string _frag_source;
+
+  mutable std::vector<int> _uniform_locations;
+  std::optional<UniformBlockLayout> _uniform_block_layouts[4];
 };
 }  // namespace pancake
\ No newline at end of file
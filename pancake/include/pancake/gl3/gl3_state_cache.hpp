@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace pancake {
+// mirrors the bindings and capabilities the renderer touches so redundant GL calls are skipped.
+// anything changing that state behind its back, or deleting a bound object, must invalidate it
+class GL3StateCache {
+ public:
+  static constexpr unsigned int MAX_TEXTURE_UNITS = 32;
+
+  static GL3StateCache& get();
+
+  void useProgram(unsigned int program);
+  void bindVertexArray(unsigned int vao);
+  void bindReadFramebuffer(unsigned int fbo);
+  void bindDrawFramebuffer(unsigned int fbo);
+  void bindFramebuffer(unsigned int fbo);
+  void bindTexture(unsigned int unit, unsigned int texture);
+  // binds to whichever unit is active, for uploads and parameter changes
+  void bindTexture(unsigned int texture);
+  void setDepthTest(bool enabled);
+  void setBlend(bool enabled);
+
+  void invalidate();
+
+  uint64_t issuedCalls() const;
+  uint64_t skippedCalls() const;
+
+ private:
+  GL3StateCache();
+
+  // unknown state never matches, so the next call always goes through
+  static constexpr unsigned int UNKNOWN = ~0u;
+
+  template <typename T>
+  bool change(T& current, T value);
+
+  unsigned int _program;
+  unsigned int _vao;
+  unsigned int _read_framebuffer;
+  unsigned int _draw_framebuffer;
+  unsigned int _active_unit;
+  std::array<unsigned int, MAX_TEXTURE_UNITS> _textures;
+  unsigned int _depth_test;
+  unsigned int _blend;
+
+  uint64_t _issued_calls;
+  uint64_t _skipped_calls;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -1,23 +1,39 @@
 #pragma once
 
+#include "graphics/buffer_format.hpp"
 #include "graphics/texture.hpp"
+#include "pancake.hpp"
 
 #include <span>
 
 namespace pancake {
+class GL3UploadQueue;
 class GL3Texture : public Texture {
  public:
-  GL3Texture(const TexturePropsResource& texture_props);
+  struct GLFormat {
+    unsigned int internal_format;
+    unsigned int format;
+    unsigned int type;
+  };
+
+  // without an upload queue image data is uploaded immediately
+  GL3Texture(const TexturePropsResource& texture_props,
+             Ptr<GL3UploadQueue> upload_queue = nullptr);
   virtual ~GL3Texture();
 
   virtual void bind(int slot) const override;
 
   unsigned int getId() const;
 
+  static GLFormat glFormat(BufferFormat format);
+
   virtual void update(const TexturePropsResource& texture_props) override;
   virtual void update(const ImageResource& image) override;
+  void updateRegion(const ImageResource& image, const Vec2i& position, const Vec2i& size);
 
  private:
   unsigned int _tex;
+  Ptr<GL3UploadQueue> _upload_queue;
+  size_t _pending_uploads;
 };
 }  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "graphics/uniform_buffer.hpp"
+
+namespace pancake {
+class GL3UniformBuffer : public UniformBuffer {
+ public:
+  GL3UniformBuffer();
+  virtual ~GL3UniformBuffer();
+
+  virtual void update(std::span<const std::byte> data) override;
+  virtual void bind(UniformBlock block, size_t offset, size_t size) const override;
+
+ private:
+  unsigned int _ubo;
+  size_t _size;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "util/matrix.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace pancake {
+class ImageResource;
+
+// stages texture and buffer uploads through one streaming buffer object. each flush copies at
+// most the frame budget (and always at least one upload), so large loads are spread over frames
+class GL3UploadQueue {
+ public:
+  GL3UploadQueue(size_t frame_budget);
+  ~GL3UploadQueue();
+
+  void queueTexture(const void* owner,
+                    unsigned int texture,
+                    unsigned int format,
+                    const ImageResource& image,
+                    const Vec2i& position,
+                    const Vec2i& size,
+                    std::function<void()> on_complete = {});
+  void queueBuffer(const void* owner,
+                   unsigned int buffer,
+                   size_t offset,
+                   std::span<const std::byte> bytes,
+                   std::function<void()> on_complete = {});
+
+  // drops every pending upload queued by owner
+  void cancel(const void* owner);
+
+  void flush();
+  // copies every pending upload queued by owner regardless of the budget, for data needed now
+  void flush(const void* owner);
+
+  size_t pendingBytes() const;
+
+ private:
+  struct Upload {
+    const void* owner;
+    unsigned int texture;
+    unsigned int format;
+    Vec2i position;
+    Vec2i size;
+    unsigned int buffer;
+    size_t offset;
+    std::vector<std::byte> data;
+    std::function<void()> on_complete;
+  };
+
+  void submit(size_t num_uploads, size_t staged_bytes);
+  bool stage(size_t num_uploads, size_t staged_bytes);
+
+  size_t _frame_budget;
+  unsigned int _staging_buffer;
+  size_t _staging_capacity;
+  std::deque<Upload> _uploads;
+  size_t _pending_bytes;
+};
+}  // namespace pancake
\ No newline at end of file
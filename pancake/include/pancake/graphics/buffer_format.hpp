@@ -1,5 +1,6 @@
 #pragma once
 
 namespace pancake {
-enum class BufferFormat { RGBA32F, RGBA32UI };
+// new formats are appended so serialised values stay stable
+enum class BufferFormat { RGBA32F, RGBA32UI, RGBA8, SRGB8_A8, R8 };
 }  // namespace pancake
\ No newline at end of file
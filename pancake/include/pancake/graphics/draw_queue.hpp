@@ -0,0 +1,224 @@
+#pragma once
+
+#include "ecs/common.hpp"
+#include "graphics/draw_options.hpp"
+#include "graphics/shader_input_block.hpp"
+#include "pancake.hpp"
+#include "util/guid.hpp"
+#include "util/matrix.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace pancake {
+struct CommonPerInstanceData {
+  Mat4f mvp_transform = Mat4f::ones();
+  Mat4f model_transform = Mat4f::ones();
+  Entity entity = Entity::null;
+};
+
+// per sprite instance, expanded into a quad by the sprite shader. uv_rect is the atlas offset and
+// size normalised to 16 bits, colour is packed rgba8
+struct SpriteInstanceData {
+  Vec2f position = Vec2f::zeros();
+  Vec2f scale = Vec2f::ones();
+  float rotation = 0.f;
+  uint16_t uv_rect[4] = {0, 0, 0xFFFF, 0xFFFF};
+  uint32_t colour = 0xFFFFFFFF;
+};
+
+static_assert(sizeof(SpriteInstanceData) == 32);
+
+struct SortKey {
+  uint64_t key;
+  uint32_t index;
+};
+
+// stable LSD radix sort, passes where every key shares the same byte are skipped
+void radixSort(std::vector<SortKey>& keys, std::vector<SortKey>& scratch);
+
+// maps values to dense per-frame slot indices in order of first appearance
+template <typename T>
+class SlotTable {
+ public:
+  uint32_t get(const T& value) {
+    const auto [it, inserted] = _slots.try_emplace(value, static_cast<uint32_t>(_values.size()));
+    if (inserted) {
+      _values.push_back(&it->first);
+    }
+    return it->second;
+  }
+
+  const T& operator[](uint32_t slot) const { return *_values[slot]; }
+
+  uint32_t size() const { return static_cast<uint32_t>(_values.size()); }
+
+  void clear() {
+    _slots.clear();
+    _values.clear();
+  }
+
+  // forgets every value from slot size onwards
+  void truncate(uint32_t size) {
+    for (uint32_t slot = size; slot < _values.size(); ++slot) {
+      _slots.erase(_slots.find(*_values[slot]));
+    }
+    _values.resize((std::min)(size, this->size()));
+  }
+
+ private:
+  std::unordered_map<T, uint32_t> _slots;
+  std::vector<const T*> _values;
+};
+
+using ShaderInputsSlotTable = SlotTable<Ptr<const ShaderInputBlock>>;
+
+class DrawQueue {
+ public:
+  static constexpr uint32_t NO_CAMERA = ~0u;
+  static constexpr uint32_t NO_MATERIAL = ~0u;
+
+  struct Batch {
+    int stage;
+    DrawOptions options;
+    uint32_t framebuffer;
+    uint32_t shader;
+    uint32_t camera;
+    uint32_t material;
+    uint32_t inputs;
+    uint32_t mesh;
+    uint32_t lod;
+    bool sprites;
+    uint32_t first_instance;
+    uint32_t num_instances;
+    uint64_t key;
+  };
+
+  DrawQueue() = default;
+  ~DrawQueue() = default;
+
+  void push(int stage,
+            const GUID& framebuffer,
+            const DrawOptions& options,
+            const GUID& shader,
+            const Ptr<const ShaderInputBlock>& inputs,
+            const GUID& mesh,
+            const CommonPerInstanceData& cpid,
+            uint32_t camera = NO_CAMERA,
+            const std::optional<GUID>& material = std::nullopt,
+            uint32_t lod = 0);
+
+  void pushSprite(int stage,
+                  const GUID& framebuffer,
+                  const DrawOptions& options,
+                  const GUID& shader,
+                  const Ptr<const ShaderInputBlock>& inputs,
+                  const SpriteInstanceData& sprite,
+                  uint32_t camera,
+                  const GUID& material);
+
+  // retained packets outlive clear() and are only re-sorted after clearRetained(). they must be
+  // pushed before any other packet of the frame
+  uint32_t pushRetained(int stage,
+                        const GUID& framebuffer,
+                        const DrawOptions& options,
+                        const GUID& shader,
+                        const Ptr<const ShaderInputBlock>& inputs,
+                        const GUID& mesh,
+                        const CommonPerInstanceData& cpid,
+                        uint32_t camera = NO_CAMERA,
+                        const std::optional<GUID>& material = std::nullopt,
+                        uint32_t lod = 0);
+
+  // patches a retained packet's instance in place, without re-sorting
+  void patchRetained(uint32_t packet, const CommonPerInstanceData& cpid);
+  // a changed level of detail only re-sorts the retained packets on the next sort()
+  void setRetainedLod(uint32_t packet, uint32_t lod);
+  uint32_t retainedCamera(uint32_t packet) const;
+  uint32_t retainedLod(uint32_t packet) const;
+
+  // sorts packets by key and groups identical draws into batches of contiguous instances
+  void sort();
+  void clear();
+  void clearRetained();
+
+  const std::vector<Batch>& batches() const;
+  std::span<const CommonPerInstanceData> instances() const;
+  std::span<const CommonPerInstanceData> instances(const Batch& batch) const;
+  std::span<const SpriteInstanceData> spriteInstances() const;
+  std::span<const SpriteInstanceData> spriteInstances(const Batch& batch) const;
+
+  const SlotTable<GUID>& framebuffers() const;
+  const SlotTable<GUID>& shaders() const;
+  const SlotTable<GUID>& materials() const;
+  const ShaderInputsSlotTable& inputs() const;
+  const SlotTable<GUID>& meshes() const;
+
+ private:
+  struct Packet {
+    int stage;
+    DrawOptions options;
+    uint32_t framebuffer;
+    uint32_t shader;
+    uint32_t camera;
+    uint32_t material;
+    uint32_t inputs;
+    uint32_t mesh;
+    uint32_t lod;
+    bool sprite;
+    uint32_t instance;
+
+    uint64_t key() const;
+    // whether any slot is too wide for its field of key()
+    bool keyOverflows() const;
+    // full slot order, for packets whose keys collide
+    bool orderedBefore(const Packet& other) const;
+    bool batchesWith(const Packet& other) const;
+  };
+
+  Packet makePacket(int stage,
+                    const GUID& framebuffer,
+                    const DrawOptions& options,
+                    const GUID& shader,
+                    const Ptr<const ShaderInputBlock>& inputs,
+                    const GUID& mesh,
+                    uint32_t camera,
+                    const std::optional<GUID>& material,
+                    uint32_t lod,
+                    uint32_t instance);
+  void sortPackets(std::span<const Packet> packets,
+                   std::span<const CommonPerInstanceData> instances,
+                   std::vector<Batch>& batches,
+                   std::vector<uint32_t>* instance_slots);
+
+  std::vector<Packet> _packets;
+  std::vector<CommonPerInstanceData> _instances;
+  std::vector<SpriteInstanceData> _sprite_instances;
+
+  std::vector<SortKey> _keys;
+  std::vector<SortKey> _scratch;
+
+  std::vector<Packet> _retained_packets;
+  std::vector<CommonPerInstanceData> _retained_instances;
+  std::vector<Batch> _retained_batches;
+  std::vector<uint32_t> _retained_instance_slots;
+  std::array<uint32_t, 5> _retained_slots = {};
+  bool _retained_sorted = true;
+
+  std::vector<Batch> _transient_batches;
+  std::vector<Batch> _batches;
+  std::vector<CommonPerInstanceData> _sorted_instances;
+  std::vector<SpriteInstanceData> _sorted_sprite_instances;
+
+  SlotTable<GUID> _framebuffers;
+  SlotTable<GUID> _shaders;
+  SlotTable<GUID> _materials;
+  ShaderInputsSlotTable _inputs;
+  SlotTable<GUID> _meshes;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace pancake {
+// picks a render scale that holds gpu frame time under a target. gpu time is taken to grow with
+// the pixel count, the square of the scale, and the scale only moves in fixed steps, waiting for
+// timings to settle after each one so framebuffers aren't reallocated every frame
+class DynamicResolution {
+ public:
+  static constexpr float SCALE_STEP = 0.05f;
+  static constexpr uint32_t SETTLE_FRAMES = 60;
+
+  DynamicResolution(double target_milliseconds, float min_scale, float max_scale);
+
+  // called once a frame with the average gpu frame time, 0 when there are no gpu timings
+  float update(double gpu_milliseconds);
+
+  float scale() const;
+  double targetMilliseconds() const;
+
+ private:
+  double _target_milliseconds;
+  float _min_scale;
+  float _max_scale;
+  float _scale;
+  uint32_t _settle_frames;
+};
+}  // namespace pancake
\ No newline at end of file
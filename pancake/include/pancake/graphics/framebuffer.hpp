@@ -21,6 +21,13 @@ class Framebuffer {
 
   void update(const FramebufferInfo& info);
 
+  // whether the targets are laid out exactly as info describes, so this can stand in for it
+  bool matches(const FramebufferInfo& info) const;
+
+  // binds for the first draws of a pass, clearing only if drawn to since the last clear
+  void begin();
+  void clearIfDrawn();
+
   virtual void bind() = 0;
   virtual void preRender() = 0;
 
@@ -42,5 +49,6 @@ class Framebuffer {
   GUID _guid = GUID::null;
   Vec2i _size = Vec2i::zeros();
   bool _active = true;
+  bool _drawn = true;
 };
 }  // namespace pancake
\ No newline at end of file
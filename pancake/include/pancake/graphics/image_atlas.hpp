@@ -5,9 +5,11 @@
 #include "util/guid.hpp"
 #include "util/matrix.hpp"
 
+#include <memory>
 #include <optional>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace pancake {
 class Resources;
@@ -21,7 +23,12 @@ class ImageAtlas {
     uint64_t gen;
   };
 
-  virtual ~ImageAtlas() = default;
+  struct Region {
+    Vec2i position;
+    Vec2i size;
+  };
+
+  virtual ~ImageAtlas();
 
   void add(const GUID& image_guid);
   void add(const ImageResource& image);
@@ -29,6 +36,10 @@ class ImageAtlas {
   const std::unordered_map<GUID, Rect>& getRects() const;
   const std::unordered_set<GUID>& getRejectedImages() const;
 
+  // regions of the underlying image written since the last clearDirtyRegions()
+  const std::vector<Region>& getDirtyRegions() const;
+  void clearDirtyRegions();
+
   void update(Resources& resources);
 
   ImageResource& image();
@@ -36,7 +47,15 @@ class ImageAtlas {
   uint64_t gen() const;
 
  private:
+  struct Packer;
+
+  bool packPending(Resources& resources);
+  void repack(Resources& resources);
+  void markDirty(const Vec2i& position, const Vec2i& size);
+
   ImageResource _underlying_image;
+  std::unique_ptr<Packer> _packer;
+  std::vector<Region> _dirty_regions;
   std::unordered_set<GUID> _pending_images;
   std::unordered_set<GUID> _rejected_images;
   std::unordered_map<GUID, Rect> _packed_rects;
@@ -15,5 +15,6 @@ struct LightInfo {
 
   Vec3f position = Vec3f::zeros();
   Vec4f color = Vec4f::ones();
+  float radius = 0.f;
 };
 }  // namespace pancake
\ No newline at end of file
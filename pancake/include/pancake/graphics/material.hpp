@@ -1,11 +1,17 @@
 #pragma once
 
+#include "graphics/uniform_buffer.hpp"
 #include "resources/material_resource.hpp"
 #include "resources/resource_user.hpp"
 #include "util/guid.hpp"
 
+#include <memory>
+#include <optional>
+#include <vector>
+
 namespace pancake {
 class Renderer;
+class Shader;
 
 struct MaterialOrigin {};
 
@@ -22,10 +28,21 @@ class Material
 
   const GUID& getShader() const;
   bool getDepthTest() const;
+  bool getOpaque() const;
   int getStage() const;
   std::string_view getLightPassInputName() const;
   std::string_view getViewInputName() const;
   const std::set<ShaderInput>& getInputs() const;
+  const std::vector<ShaderInput>& getTextureInputs() const;
+  const std::vector<ShaderInput>& getUniformInputs() const;
+  const std::optional<UniformId>& getViewPositionUniform() const;
+  const std::optional<UniformId>& getViewTransformUniform() const;
+
+  void setUniformBuffer(std::unique_ptr<UniformBuffer> uniform_buffer);
+  const UniformBuffer* getUniformBuffer() const;
+
+  // repacks the uniform inputs into the shader's material block if either has changed
+  void updateUniformBuffer(const Shader& shader);
 
   const GUID& guid() const;
 
@@ -33,9 +50,19 @@ class Material
   GUID _guid = GUID::null;
   GUID _shader = GUID::null;
   bool _depth_test = true;
+  bool _opaque = false;
   int _stage = -1;
   std::string _light_pass_input_name = "";
   std::string _view_input_name = "";
   std::set<ShaderInput> _inputs{};
+  std::vector<ShaderInput> _texture_inputs{};
+  std::vector<ShaderInput> _uniform_inputs{};
+  std::optional<UniformId> _view_position_uniform{};
+  std::optional<UniformId> _view_transform_uniform{};
+
+  std::unique_ptr<UniformBuffer> _uniform_buffer{};
+  bool _uniform_buffer_outdated = true;
+  GUID _uniform_buffer_shader = GUID::null;
+  uint64_t _uniform_buffer_shader_gen = 0;
 };
 }  // namespace pancake
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "graphics/mesh_lod.hpp"
 #include "resources/mesh_resource_interface.hpp"
 #include "resources/resource_user.hpp"
 #include "util/guid.hpp"
@@ -7,6 +8,10 @@
 
 #include "graphics/shader.hpp"
 
+#include <cstdint>
+#include <span>
+#include <vector>
+
 namespace pancake {
 struct MeshRes {};
 
@@ -14,8 +19,15 @@ class Mesh : public ResourceUser<Mesh, ResourceUse<Mesh, MeshResourceInterface,
  public:
   virtual ~Mesh() = default;
 
-  virtual void update(std::span<const Vertex> vertices, std::span<const unsigned int> indices) = 0;
-  virtual void draw(unsigned int num_instances = 1) const = 0;
+  virtual void update(std::span<const Vertex> vertices,
+                      std::span<const unsigned int> indices,
+                      const VertexLayout& layout = VertexLayout::full(),
+                      std::span<const unsigned int> lod_indices = {},
+                      std::span<const MeshLod> lods = {}) = 0;
+  // levels beyond those uploaded draw at full detail
+  virtual void draw(unsigned int num_instances = 1,
+                    unsigned int first_instance = 0,
+                    uint32_t lod = 0) const = 0;
 
   template <typename T>
   void resourceUpdated(const MeshResourceInterface& res);
@@ -23,11 +35,34 @@ class Mesh : public ResourceUser<Mesh, ResourceUse<Mesh, MeshResourceInterface,
   void resourcesUpdated();
 
   const GUID& guid() const;
+  std::span<const MeshLod> lods() const;
+
+  // local space bounds of every vertex
+  const Vec3f& boundsMin() const;
+  const Vec3f& boundsMax() const;
+
+  // full detail triangles kept on the cpu for occlusion culling, empty when there are more than
+  // MAX_OCCLUDER_TRIANGLES
+  std::span<const Vec3f> occluderPositions() const;
+  std::span<const unsigned int> occluderIndices() const;
+
+  static constexpr size_t MAX_OCCLUDER_TRIANGLES = 4096;
 
  protected:
   Mesh(const GUID& guid);
 
+  // called by update implementations, refreshes the lods, bounds and occluder triangles
+  void updateShape(std::span<const Vertex> vertices,
+                   std::span<const unsigned int> indices,
+                   std::span<const MeshLod> lods);
+
+  std::vector<MeshLod> _lods;
+
  private:
   GUID _guid;
+  Vec3f _bounds_min;
+  Vec3f _bounds_max;
+  std::vector<Vec3f> _occluder_positions;
+  std::vector<unsigned int> _occluder_indices;
 };
 }  // namespace pancake
\ No newline at end of file
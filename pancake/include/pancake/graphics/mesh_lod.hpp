@@ -0,0 +1,34 @@
+#pragma once
+
+#include "graphics/vertex.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pancake {
+// a coarser level of detail, a range of a mesh's lod indices over its full detail vertices
+struct MeshLod {
+  uint32_t first_index;
+  uint32_t num_indices;
+  // furthest the simplified surface may stray from the original, in the mesh's space
+  float error;
+
+  bool operator==(const MeshLod& rhs) const = default;
+};
+
+// full detail and up to three simplified levels
+static constexpr size_t MAX_MESH_LODS = 4;
+
+// simplifies a triangle list by quadric error edge collapse (Garland and Heckbert), roughly
+// halving its triangles per level. vertices only ever collapse onto one another, so every level
+// indexes the original vertices. levels are appended to lod_indices, coarsest last
+void buildMeshLods(std::span<const Vertex> vertices,
+                   std::span<const unsigned int> indices,
+                   std::vector<unsigned int>& lod_indices,
+                   std::vector<MeshLod>& lods);
+
+// the coarsest level whose error stays under max_pixel_error when one unit of the mesh's space
+// covers pixels_per_unit pixels. 0 is full detail, n is lods[n - 1]
+uint32_t selectMeshLod(std::span<const MeshLod> lods, float pixels_per_unit, float max_pixel_error);
+}  // namespace pancake
\ No newline at end of file
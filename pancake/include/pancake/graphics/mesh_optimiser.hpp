@@ -0,0 +1,19 @@
+#pragma once
+
+#include "graphics/vertex.hpp"
+
+#include <span>
+#include <vector>
+
+namespace pancake {
+// reorders triangles for post-transform vertex cache hits, following Forsyth's linear-speed
+// vertex cache optimisation. indices must be a triangle list
+void optimiseVertexCache(std::span<unsigned int> indices, size_t num_vertices);
+
+// reorders vertices into first use order so fetches walk memory linearly, unused vertices are
+// dropped and indices remapped
+void optimiseVertexFetch(std::vector<Vertex>& vertices, std::span<unsigned int> indices);
+
+// both of the above, for meshes as they are imported
+void optimiseMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+}  // namespace pancake
\ No newline at end of file
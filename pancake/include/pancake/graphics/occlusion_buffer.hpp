@@ -0,0 +1,49 @@
+#pragma once
+
+#include "util/matrix.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace pancake {
+// low resolution depth buffer rasterised on the cpu from a camera's largest occluders, with a
+// pyramid of max depths that instance bounds are tested against before they are drawn
+class OcclusionBuffer {
+ public:
+  // longest side of the buffer, the other follows the framebuffer's aspect
+  static constexpr int MAX_SIZE = 256;
+
+  void clear(const Vec2i& framebuffer_size);
+
+  // triangles crossing the near plane are skipped, so occluders only ever hide too little
+  void rasterise(std::span<const Vec3f> positions,
+                 std::span<const unsigned int> indices,
+                 const Mat4f& mvp);
+
+  // builds the pyramid, after the last occluder
+  void finish();
+
+  // fraction of the buffer covered by a box's screen rect, 1 if it crosses the near plane
+  float coverage(const Vec3f& min, const Vec3f& max, const Mat4f& mvp) const;
+
+  // false if a box is outside the frustum or behind every occluder it could overlap
+  bool visible(const Vec3f& min, const Vec3f& max, const Mat4f& mvp) const;
+
+ private:
+  struct Footprint {
+    float min_x;
+    float min_y;
+    float max_x;
+    float max_y;
+    float depth;
+    bool clipped;
+  };
+
+  bool project(const Vec3f& min, const Vec3f& max, const Mat4f& mvp, Footprint& footprint) const;
+
+  std::vector<Vec2i> _sizes;
+  std::vector<std::vector<float>> _levels;
+  bool _empty = true;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include "graphics/uniform_buffer.hpp"
+#include "graphics/uniform_id.hpp"
 #include "pancake.hpp"
 #include "resources/resource_user.hpp"
 #include "resources/shader_resource_interface.hpp"
@@ -17,18 +19,22 @@ class Shader
  public:
   virtual ~Shader() = default;
 
-  virtual void compileVertexSource(std::string_view source) = 0;
-  virtual void compileFragmentSource(std::string_view source) = 0;
+  // sources are only kept until linkProgram(), which compiles them or loads a cached binary
+  virtual void setVertexSource(std::string_view source) = 0;
+  virtual void setFragmentSource(std::string_view source) = 0;
   virtual void linkProgram() = 0;
 
   virtual void use() const = 0;
 
-  virtual void setUniform(std::string_view name, int value) const = 0;
-  virtual void setUniform(std::string_view name, float value) const = 0;
-  virtual void setUniform(std::string_view name, const Vec3f& value) const = 0;
-  virtual void setUniform(std::string_view name, const Vec4f& value) const = 0;
-  virtual void setUniform(std::string_view name, const Vec4u& value) const = 0;
-  virtual void setUniform(std::string_view name, const Mat4f& value) const = 0;
+  virtual void setUniform(const UniformId& id, int value) const = 0;
+  virtual void setUniform(const UniformId& id, float value) const = 0;
+  virtual void setUniform(const UniformId& id, const Vec3f& value) const = 0;
+  virtual void setUniform(const UniformId& id, const Vec4f& value) const = 0;
+  virtual void setUniform(const UniformId& id, const Vec4u& value) const = 0;
+  virtual void setUniform(const UniformId& id, const Mat4f& value) const = 0;
+
+  // nullptr when the program doesn't declare the block
+  virtual const UniformBlockLayout* getUniformBlockLayout(UniformBlock block) const = 0;
 
   template <typename T>
   void resourceUpdated(const ShaderResourceInterface& res);
@@ -36,6 +42,10 @@ class Shader
   void resourcesUpdated();
 
   const GUID& guid() const;
+  uint64_t gen() const;
+
+  // whether the fragment source can discard, leaving holes in what it draws
+  bool discards() const;
 
   Ptr<Shader> ptr();
   Ptr<const Shader> ptr() const;
@@ -48,5 +58,7 @@ class Shader
 
  private:
   GUID _guid;
+  uint64_t _gen;
+  bool _discards;
 };
 }  // namespace pancake
\ No newline at end of file
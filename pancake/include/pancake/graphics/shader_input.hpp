@@ -2,11 +2,13 @@
 
 #include "components/2d.hpp"
 #include "graphics/light_info.hpp"
+#include "graphics/uniform_id.hpp"
 #include "pancake.hpp"
 #include "util/matrix.hpp"
 
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <variant>
 
@@ -28,6 +30,13 @@ class ShaderInput {
 
   Type getType() const;
   std::string_view getName() const;
+  const UniformId& getId() const;
+  const TextureRef* getTextureRef() const;
+
+  // copies the value as laid out in a std140 block, textures and lights aren't block members
+  void writeStd140(std::span<std::byte> dst) const;
+
+  size_t hash() const;
 
   void toJson(JSONObject& json) const;
 
@@ -37,7 +46,8 @@ class ShaderInput {
   bool operator==(const ShaderInput& rhs) const;
 
  private:
-  std::string _name;
+  UniformId _name;
   Value _value;
+  UniformId _sub_names[2];
 };
 }  // namespace pancake
\ No newline at end of file
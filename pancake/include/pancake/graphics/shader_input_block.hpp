@@ -0,0 +1,30 @@
+#pragma once
+
+#include "graphics/shader_input.hpp"
+#include "pancake.hpp"
+
+#include <set>
+#include <span>
+#include <vector>
+
+namespace pancake {
+// immutable set of shader inputs, interned so equal blocks can be compared by pointer
+class ShaderInputBlock {
+ public:
+  ~ShaderInputBlock() = default;
+
+  std::span<const ShaderInput> inputs() const;
+  size_t hash() const;
+
+  static Ptr<const ShaderInputBlock> intern(const std::set<ShaderInput>& inputs);
+
+  // forgets blocks no longer referenced
+  static void collect();
+
+ private:
+  ShaderInputBlock(const std::set<ShaderInput>& inputs, size_t hash);
+
+  std::vector<ShaderInput> _inputs;
+  size_t _hash;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "graphics/uniform_id.hpp"
+#include "util/matrix.hpp"
+
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace pancake {
+// binding points, shaders opt in by declaring std140 blocks without instance names :
+// PancakeFrame { float time; }
+// PancakeCamera { mat4 projection_transform; mat4 view_transform; vec4 view_position; }
+// PancakeMaterial { ... } laid out freely, filled from the material's non-texture inputs by name
+// PancakeLights { uvec4 light_count; vec4 light_grid; vec4 light_positions[64];
+//                 vec4 light_colors[64]; uvec4 tile_light_masks[128]; }
+enum class UniformBlock { Frame, Camera, Material, Lights };
+
+struct UniformBlockLayout {
+  size_t size = 0;
+  std::vector<std::pair<UniformId, size_t>> offsets;
+};
+
+struct FrameUniforms {
+  float time = 0.f;
+  float padding[3] = {};
+};
+
+struct CameraUniforms {
+  Mat4f projection_transform = Mat4f::identity();
+  Mat4f view_transform = Mat4f::identity();
+  Vec4f view_position = Vec4f::zeros();
+};
+
+// lights are binned per camera into a grid of screen tiles, each tile holding a 64 bit mask of
+// the lights touching it. tile (x, y) counts from the bottom left like gl_FragCoord, and its mask
+// is the xy (even tile index) or zw (odd) half of tile_light_masks[(y * 16 + x) / 2]
+struct LightUniforms {
+  static constexpr int MAX_LIGHTS = 64;
+  static constexpr int TILES_X = 16;
+  static constexpr int TILES_Y = 16;
+
+  Vec4u light_count = Vec4u::zeros();
+  Vec4f light_grid = Vec4f::zeros();      // xy : tiles across and down, zw : 1 / framebuffer size
+  Vec4f light_positions[MAX_LIGHTS] = {};  // w : radius, 0 reaches every tile
+  Vec4f light_colors[MAX_LIGHTS] = {};
+  Vec4u tile_light_masks[(TILES_X * TILES_Y) / 2] = {};
+};
+
+static_assert(sizeof(FrameUniforms) == 16);
+static_assert(sizeof(CameraUniforms) == 144);
+static_assert(sizeof(LightUniforms) == 4128);
+
+class UniformBuffer {
+ public:
+  virtual ~UniformBuffer() = default;
+
+  virtual void update(std::span<const std::byte> data) = 0;
+  virtual void bind(UniformBlock block, size_t offset, size_t size) const = 0;
+
+ protected:
+  UniformBuffer() = default;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <string_view>
+
+namespace pancake {
+// interned uniform name, resolved once per shader rather than per bind
+class UniformId {
+ public:
+  UniformId(std::string_view name);
+
+  uint32_t index() const;
+  std::string_view name() const;
+
+  auto operator<=>(const UniformId&) const = default;
+
+ private:
+  uint32_t _index;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "graphics/vertex.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace pancake {
+enum class VertexAttributeType { Float32, Float16, Snorm2_10_10_10, Unorm8 };
+
+struct VertexAttribute {
+  VertexAttributeType type;
+  uint8_t components;
+  uint8_t offset;
+
+  bool operator==(const VertexAttribute& rhs) const = default;
+};
+
+// describes how each Vertex member is stored on the gpu, attributes are ordered by their shader
+// location : position, normal, tangent, colour, uv0, uv1
+class VertexLayout {
+ public:
+  static constexpr size_t NUM_ATTRIBUTES = 6;
+
+  constexpr VertexLayout(const std::array<VertexAttribute, NUM_ATTRIBUTES>& attributes,
+                         uint8_t stride)
+      : _attributes(attributes), _stride(stride) {}
+
+  // Vertex as is, 80 bytes
+  static const VertexLayout& full();
+  // float3 position, 2_10_10_10 normal and tangent, rgba8 colour, half uvs, 32 bytes
+  static const VertexLayout& compact();
+
+  const std::array<VertexAttribute, NUM_ATTRIBUTES>& attributes() const;
+  size_t stride() const;
+
+  // vertices in this layout, full() is returned as is without packing
+  std::span<const std::byte> pack(std::span<const Vertex> vertices,
+                                  std::vector<std::byte>& scratch) const;
+
+  bool operator==(const VertexLayout& rhs) const = default;
+
+ private:
+  std::array<VertexAttribute, NUM_ATTRIBUTES> _attributes;
+  uint8_t _stride;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "core/event_handler.hpp"
+
+#include <cstdint>
+
+namespace pancake {
+class NullEventHandler : public EventHandler {
+ public:
+  // quits after max_frames calls to handleEvents, 0 never quits
+  NullEventHandler(uint64_t max_frames);
+  virtual ~NullEventHandler() = default;
+
+  virtual bool handleEvents(Session& session) override;
+
+ private:
+  uint64_t _max_frames;
+  uint64_t _frames;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "graphics/framebuffer.hpp"
+
+#include "null/null_texture.hpp"
+#include "pancake.hpp"
+
+#include <vector>
+
+namespace pancake {
+class NullFramebuffer : public Framebuffer {
+ public:
+  NullFramebuffer(const GUID& guid, const FramebufferInfo& info);
+  virtual ~NullFramebuffer() = default;
+
+  virtual void bind() override;
+  virtual void preRender() override;
+
+  virtual OptTextureConstRef texture(size_t i = 0) const override;
+  virtual void readPixel(size_t attachment, const Vec2u& position, Vec4u& pixel) const override;
+
+ protected:
+  virtual void update() override;
+
+ private:
+  std::vector<Ptr<NullTexture>> _render_targets{};
+};
+}  // namespace pancake
\ No newline at end of file
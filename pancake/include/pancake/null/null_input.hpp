@@ -0,0 +1,11 @@
+#pragma once
+
+#include "core/input.hpp"
+
+namespace pancake {
+class NullInput : public Input {
+ public:
+  NullInput() = default;
+  virtual ~NullInput() = default;
+};
+}  // namespace pancake
\ No newline at end of file
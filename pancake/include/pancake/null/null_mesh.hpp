@@ -0,0 +1,33 @@
+#pragma once
+
+#include "graphics/mesh.hpp"
+
+#include <span>
+
+namespace pancake {
+class NullRenderer;
+class NullMesh : public Mesh {
+ public:
+  virtual ~NullMesh() = default;
+
+  virtual void update(std::span<const Vertex> vertices,
+                      std::span<const unsigned int> indices,
+                      const VertexLayout& layout = VertexLayout::full(),
+                      std::span<const unsigned int> lod_indices = {},
+                      std::span<const MeshLod> lods = {}) override;
+  virtual void draw(unsigned int num_instances = 1,
+                    unsigned int first_instance = 0,
+                    uint32_t lod = 0) const override;
+
+  size_t numVertices() const;
+  size_t numIndices() const;
+
+ private:
+  NullMesh(const GUID& guid);
+
+  friend NullRenderer;
+
+  size_t _num_vertices;
+  size_t _num_indices;
+};
+}  // namespace pancake
\ No newline at end of file
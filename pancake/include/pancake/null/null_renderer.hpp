@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/renderer.hpp"
+
+#include <cstdint>
+
+namespace pancake {
+// renderer backend that counts work instead of issuing graphics calls, for running sessions without
+// a gpu
+class NullRenderer : public Renderer {
+ public:
+  struct Stats {
+    uint64_t frames = 0;
+    uint64_t draw_calls = 0;
+    uint64_t instances = 0;
+    uint64_t uploaded_instances = 0;
+    uint64_t sprites = 0;
+    uint64_t uploaded_sprites = 0;
+    uint64_t texture_binds = 0;
+    uint64_t draw_option_changes = 0;
+    uint64_t screen_copies = 0;
+    uint64_t blits = 0;
+    uint64_t textures_created = 0;
+    uint64_t framebuffers_created = 0;
+    uint64_t meshes_created = 0;
+    uint64_t shaders_created = 0;
+    uint64_t uniform_buffers_created = 0;
+  };
+
+  NullRenderer();
+  virtual ~NullRenderer();
+
+  virtual int bindTexture(const Texture& texture) override;
+
+  virtual const Texture& getBlankTexture() const override;
+  virtual Ptr<Mesh> getUnitSquare() const override;
+  virtual Ptr<Shader> getDefaultShader() const override;
+  virtual Ptr<Shader> getSpriteShader() const override;
+
+  virtual void preRender(Session& session, Resources& resources) override;
+  virtual void render() override;
+
+  const Stats& stats() const;
+
+ protected:
+  virtual void drawMeshInstances(const Mesh& mesh,
+                                 uint32_t lod,
+                                 std::span<const CommonPerInstanceData> cpids) override;
+  virtual void drawSpriteInstances(std::span<const SpriteInstanceData> sprites) override;
+
+  virtual Texture* createTexture(const TexturePropsResource& texture_props) override;
+  virtual std::unique_ptr<Framebuffer> createFramebuffer(const GUID& guid,
+                                                         const FramebufferInfo& info) override;
+
+  virtual std::unique_ptr<Mesh> createMesh(const GUID& guid) override;
+  virtual std::unique_ptr<Mesh> createMesh(const GUID& guid,
+                                           std::span<const Vertex> vertices,
+                                           std::span<const unsigned int> indices) override;
+  virtual std::unique_ptr<Shader> createShader(const ShaderResourceInterface& res) override;
+  virtual std::unique_ptr<UniformBuffer> createUniformBuffer() override;
+
+  virtual size_t uniformBufferOffsetAlignment() const override;
+
+  virtual void useDrawOptions(const DrawOptions& options) override;
+
+  virtual void uploadInstances(std::span<const CommonPerInstanceData> cpids) override;
+  virtual void uploadSpriteInstances(std::span<const SpriteInstanceData> sprites) override;
+
+  virtual void copyToScreen(Framebuffer& framebuffer) override;
+  virtual void blit(Framebuffer& dst, const Framebuffer& src) override;
+
+  virtual void beginGPUTimer(std::string name) override;
+  virtual void endGPUTimer() override;
+
+ private:
+  Stats _stats;
+  GUID _sprite_shader;
+};
+}  // namespace pancake
\ No newline at end of file
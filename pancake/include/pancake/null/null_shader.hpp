@@ -0,0 +1,31 @@
+#pragma once
+
+#include "graphics/shader.hpp"
+
+namespace pancake {
+class NullRenderer;
+class NullShader : public Shader {
+ public:
+  virtual ~NullShader() = default;
+
+  virtual void setVertexSource(std::string_view source) override;
+  virtual void setFragmentSource(std::string_view source) override;
+  virtual void linkProgram() override;
+
+  virtual void use() const override;
+
+  virtual void setUniform(const UniformId& id, int value) const override;
+  virtual void setUniform(const UniformId& id, float value) const override;
+  virtual void setUniform(const UniformId& id, const Vec3f& value) const override;
+  virtual void setUniform(const UniformId& id, const Vec4f& value) const override;
+  virtual void setUniform(const UniformId& id, const Vec4u& value) const override;
+  virtual void setUniform(const UniformId& id, const Mat4f& value) const override;
+
+  virtual const UniformBlockLayout* getUniformBlockLayout(UniformBlock block) const override;
+
+ private:
+  NullShader(const GUID& guid);
+
+  friend NullRenderer;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "graphics/texture.hpp"
+
+namespace pancake {
+class NullTexture : public Texture {
+ public:
+  NullTexture(const TexturePropsResource& texture_props);
+  virtual ~NullTexture() = default;
+
+  virtual void bind(int slot) const override;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "graphics/uniform_buffer.hpp"
+
+namespace pancake {
+class NullUniformBuffer : public UniformBuffer {
+ public:
+  NullUniformBuffer() = default;
+  virtual ~NullUniformBuffer() = default;
+
+  virtual void update(std::span<const std::byte> data) override;
+  virtual void bind(UniformBlock block, size_t offset, size_t size) const override;
+};
+}  // namespace pancake
\ No newline at end of file
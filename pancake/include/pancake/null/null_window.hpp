@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/window.hpp"
+
+namespace pancake {
+class NullWindow : public Window {
+ public:
+  NullWindow(const Vec2i& size);
+  virtual ~NullWindow();
+
+  virtual void newImGuiFrame() override;
+  virtual void flip() override;
+
+  virtual Vec2i size() const override;
+
+ private:
+  Vec2i _size;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -35,6 +35,8 @@ class GltfPrimitiveResource
 
   virtual std::span<const Vertex> getVertices() const override;
   virtual std::span<const unsigned int> getIndices() const override;
+  virtual std::span<const unsigned int> getLodIndices() const override;
+  virtual std::span<const MeshLod> getLods() const override;
 
   virtual Resource& asResource() override;
 
@@ -52,5 +54,7 @@ class GltfPrimitiveResource
 
   std::vector<Vertex> _vertices;
   std::vector<unsigned int> _indices;
+  std::vector<unsigned int> _lod_indices;
+  std::vector<MeshLod> _lods;
 };
 }  // namespace pancake
\ No newline at end of file
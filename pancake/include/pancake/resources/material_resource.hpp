@@ -14,6 +14,7 @@ class MaterialResource : public JSONResource {
 
   void setShader(const GUID& shader);
   void setDepthTest(bool value);
+  void setOpaque(bool value);
   void setStage(int stage);
   void setLightPassInputName(std::string_view input_name);
   void setViewInputName(std::string_view input_name);
@@ -23,6 +24,8 @@ class MaterialResource : public JSONResource {
 
   const GUID& getShader() const;
   bool getDepthTest() const;
+  // fully covers what it draws over, with no blending or alpha testing
+  bool getOpaque() const;
   int getStage() const;
   std::string_view getLightPassInputName() const;
   std::string_view getViewInputName() const;
@@ -40,6 +43,7 @@ class MaterialResource : public JSONResource {
  private:
   GUID _shader = GUID::null;
   bool _depth_test = true;
+  bool _opaque = false;
   int _stage = 10000;
   std::string _light_pass_input_name = "";
   std::string _view_input_name = "";
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "graphics/mesh_lod.hpp"
 #include "graphics/vertex.hpp"
+#include "graphics/vertex_layout.hpp"
 #include "resources/resource.hpp"
 
 #include <span>
@@ -13,6 +15,11 @@ class MeshResourceInterface {
 
   virtual std::span<const Vertex> getVertices() const = 0;
   virtual std::span<const unsigned int> getIndices() const = 0;
+  virtual const VertexLayout& getVertexLayout() const { return VertexLayout::compact(); }
+
+  // simplified levels over the same vertices, each a range of the lod indices
+  virtual std::span<const unsigned int> getLodIndices() const { return {}; }
+  virtual std::span<const MeshLod> getLods() const { return {}; }
 
   virtual Resource& asResource() = 0;
 };
@@ -33,6 +33,8 @@ class ObjMeshResource
 
   virtual std::span<const Vertex> getVertices() const override;
   virtual std::span<const unsigned int> getIndices() const override;
+  virtual std::span<const unsigned int> getLodIndices() const override;
+  virtual std::span<const MeshLod> getLods() const override;
 
   virtual Resource& asResource() override;
 
@@ -49,5 +51,7 @@ class ObjMeshResource
 
   std::vector<Vertex> _vertices;
   std::vector<unsigned int> _indices;
+  std::vector<unsigned int> _lod_indices;
+  std::vector<MeshLod> _lods;
 };
 }  // namespace pancake
\ No newline at end of file
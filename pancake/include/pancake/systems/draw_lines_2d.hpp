@@ -1,16 +1,33 @@
 #pragma once
 
+#include "ecs/caching_system.hpp"
 #include "ecs/draw_system.hpp"
 
+#include "components/common.hpp"
+#include "graphics/shader_input_block.hpp"
+#include "graphics/vertex.hpp"
 #include "pancake.hpp"
 #include "util/guid.hpp"
 
+#include <map>
+#include <vector>
+
 namespace pancake {
-class Mesh;
-class Shader;
-class DrawLines2D : public DrawSystem {
+// every line sharing a camera mask and colour, tessellated into one mesh
+struct PolylineBatch {
+  GUID mesh;
+  Ptr<const ShaderInputBlock> inputs;
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  std::vector<Vertex> uploaded_vertices;
+  std::vector<unsigned int> uploaded_indices;
+};
+
+using PolylineBatches = std::map<std::pair<CameraMask, Vec4f>, PolylineBatch>;
+
+class DrawLines2D : public CachingSystem<PolylineBatches, DrawSystem> {
  public:
-  using DrawSystem::DrawSystem;
+  using CachingSystem<PolylineBatches, DrawSystem>::CachingSystem;
   virtual ~DrawLines2D() = default;
 
   virtual std::string_view name() const override;
@@ -20,11 +37,9 @@ class DrawLines2D : public DrawSystem {
   virtual const ComponentAccess& getComponentAccess() const override;
 
  protected:
-  virtual void _configure(Session& session) override;
-  virtual void _run(const SessionWrapper& session, const WorldWrapper& world) const override;
-
- private:
-  GUID _mesh = GUID::null;
-  GUID _shader = GUID::null;
+  virtual void _run(const SessionWrapper& session,
+                    const WorldWrapper& world,
+                    PolylineBatches& batches) const override;
+  virtual void _releaseCache(Session& session, PolylineBatches& batches) const override;
 };
 }  // namespace pancake
\ No newline at end of file
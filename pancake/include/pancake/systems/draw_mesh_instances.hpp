@@ -1,14 +1,32 @@
 #pragma once
 
+#include "ecs/caching_system.hpp"
 #include "ecs/draw_system.hpp"
+
+#include "components/common.hpp"
+#include "ecs/common.hpp"
 #include "pancake.hpp"
+#include "util/guid.hpp"
+#include "util/matrix.hpp"
+
+#include <unordered_map>
 
 namespace pancake {
-class Mesh;
-class Shader;
-class DrawMeshInstances : public DrawSystem {
+// a mesh instance as it was last submitted, retained by the renderer under id
+struct RetainedMeshInstance {
+  GUID id;
+  CameraMask camera_mask;
+  GUID material;
+  GUID mesh;
+  Mat4f model;
+  bool used;
+};
+
+using RetainedMeshInstances = std::unordered_map<Entity, RetainedMeshInstance>;
+
+class DrawMeshInstances : public CachingSystem<RetainedMeshInstances, DrawSystem> {
  public:
-  using DrawSystem::DrawSystem;
+  using CachingSystem<RetainedMeshInstances, DrawSystem>::CachingSystem;
   virtual ~DrawMeshInstances() = default;
 
   virtual std::string_view name() const override;
@@ -18,6 +36,9 @@ class DrawMeshInstances : public DrawSystem {
   virtual const ComponentAccess& getComponentAccess() const override;
 
  protected:
-  virtual void _run(const SessionWrapper& session, const WorldWrapper& world) const override;
+  virtual void _run(const SessionWrapper& session,
+                    const WorldWrapper& world,
+                    RetainedMeshInstances& instances) const override;
+  virtual void _releaseCache(Session& session, RetainedMeshInstances& instances) const override;
 };
 }  // namespace pancake
\ No newline at end of file
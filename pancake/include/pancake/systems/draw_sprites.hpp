@@ -2,12 +2,7 @@
 
 #include "ecs/draw_system.hpp"
 
-#include "pancake.hpp"
-#include "util/guid.hpp"
-
 namespace pancake {
-class Mesh;
-class Shader;
 class DrawSprites : public DrawSystem {
  public:
   using DrawSystem::DrawSystem;
@@ -20,11 +15,6 @@ class DrawSprites : public DrawSystem {
   virtual const ComponentAccess& getComponentAccess() const override;
 
  protected:
-  virtual void _configure(Session& session) override;
   virtual void _run(const SessionWrapper& session, const WorldWrapper& world) const override;
-
- private:
-  GUID _mesh = GUID::null;
-  GUID _shader = GUID::null;
 };
 }  // namespace pancake
\ No newline at end of file
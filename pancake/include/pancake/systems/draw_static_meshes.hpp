@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ecs/caching_system.hpp"
+#include "ecs/draw_system.hpp"
+
+#include "components/common.hpp"
+#include "ecs/common.hpp"
+#include "pancake.hpp"
+#include "util/guid.hpp"
+#include "util/matrix.hpp"
+
+#include <vector>
+
+namespace pancake {
+// a static mesh instance as it was when the batches were last built
+struct StaticMember {
+  Entity entity;
+  GUID mesh;
+  uint64_t mesh_gen;
+  GUID material;
+  CameraMask camera_mask;
+  Mat4f model;
+  Mat4f normal_matrix;
+
+  bool operator==(const StaticMember& rhs) const = default;
+};
+
+// static geometry sharing a material, camera mask and cell, baked into world space
+struct StaticBatch {
+  GUID mesh;
+  GUID material;
+  CameraMask camera_mask;
+};
+
+struct StaticBatches {
+  std::vector<StaticMember> members;
+  std::vector<StaticBatch> batches;
+};
+
+class DrawStaticMeshes : public CachingSystem<StaticBatches, DrawSystem> {
+ public:
+  using CachingSystem<StaticBatches, DrawSystem>::CachingSystem;
+  virtual ~DrawStaticMeshes() = default;
+
+  virtual std::string_view name() const override;
+  virtual SystemId id() const override;
+
+  virtual const SessionAccess& getSessionAccess() const override;
+  virtual const ComponentAccess& getComponentAccess() const override;
+
+ protected:
+  virtual void _run(const SessionWrapper& session,
+                    const WorldWrapper& world,
+                    StaticBatches& cache) const override;
+  virtual void _releaseCache(Session& session, StaticBatches& cache) const override;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -1,12 +1,30 @@
 #pragma once
 
+#include "ecs/caching_system.hpp"
 #include "ecs/draw_system.hpp"
+
+#include "graphics/shader_input_block.hpp"
 #include "pancake.hpp"
+#include "util/guid.hpp"
+
+#include <map>
 
 namespace pancake {
-class DrawTexts : public DrawSystem {
+// a text laid out into glyph quads once, rebuilt only when the text, font or font texture changes
+struct GlyphRun {
+  uint64_t text_gen;
+  uint64_t font_gen;
+  uint64_t texture_gen;
+  GUID mesh;
+  Ptr<const ShaderInputBlock> inputs;
+  bool used;
+};
+
+using GlyphRuns = std::map<std::pair<GUID, GUID>, GlyphRun>;
+
+class DrawTexts : public CachingSystem<GlyphRuns, DrawSystem> {
  public:
-  using DrawSystem::DrawSystem;
+  using CachingSystem<GlyphRuns, DrawSystem>::CachingSystem;
   virtual ~DrawTexts() = default;
 
   virtual std::string_view name() const override;
@@ -16,6 +34,9 @@ class DrawTexts : public DrawSystem {
   virtual const ComponentAccess& getComponentAccess() const override;
 
  protected:
-  virtual void _run(const SessionWrapper& session, const WorldWrapper& world) const override;
+  virtual void _run(const SessionWrapper& session,
+                    const WorldWrapper& world,
+                    GlyphRuns& glyph_runs) const override;
+  virtual void _releaseCache(Session& session, GlyphRuns& glyph_runs) const override;
 };
 }  // namespace pancake
\ No newline at end of file
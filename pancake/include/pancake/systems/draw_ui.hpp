@@ -1,12 +1,34 @@
 #pragma once
 
+#include "ecs/caching_system.hpp"
 #include "ecs/draw_system.hpp"
+
+#include "graphics/shader_input.hpp"
 #include "pancake.hpp"
+#include "util/guid.hpp"
+#include "util/matrix.hpp"
+
+#include <set>
+#include <vector>
 
 namespace pancake {
-class DrawUI : public DrawSystem {
+struct UIDraw {
+  GUID framebuffer;
+  std::set<ShaderInput> inputs;
+  Mat4f mvp;
+
+  bool operator==(const UIDraw& rhs) const = default;
+};
+
+// the ui as it was last submitted, each draw retained by the renderer under the matching id
+struct RetainedUIDraws {
+  std::vector<UIDraw> draws;
+  std::vector<GUID> ids;
+};
+
+class DrawUI : public CachingSystem<RetainedUIDraws, DrawSystem> {
  public:
-  using DrawSystem::DrawSystem;
+  using CachingSystem<RetainedUIDraws, DrawSystem>::CachingSystem;
   virtual ~DrawUI() = default;
 
   virtual std::string_view name() const override;
@@ -16,6 +38,9 @@ class DrawUI : public DrawSystem {
   virtual const ComponentAccess& getComponentAccess() const override;
 
  protected:
-  virtual void _run(const SessionWrapper& session, const WorldWrapper& world) const override;
+  virtual void _run(const SessionWrapper& session,
+                    const WorldWrapper& world,
+                    RetainedUIDraws& retained) const override;
+  virtual void _releaseCache(Session& session, RetainedUIDraws& retained) const override;
 };
 }  // namespace pancake
\ No newline at end of file
@@ -12,7 +12,8 @@ class GltfResource;
 class Resources;
 class GltfImporter {
  public:
-  GltfImporter(const GUID& base_material);
+  // mark_static tags imported meshes for merging, for level geometry that never moves
+  GltfImporter(const GUID& base_material, bool mark_static = false);
   ~GltfImporter() = default;
 
   void import(World& world, Resources& resources, const GltfResource& gltf) const;
@@ -25,5 +26,6 @@ class GltfImporter {
                   int node_idx) const;
 
   GUID _base_material;
+  bool _mark_static;
 };
 }  // namespace pancake
\ No newline at end of file
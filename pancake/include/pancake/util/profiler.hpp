@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pancake {
+// named cpu and gpu timings, in milliseconds. gpu timings arrive a few frames after the work they
+// measure, so every timing keeps a running average rather than being tied to a single frame
+class Profiler {
+ public:
+  enum class Source { CPU, GPU };
+
+  struct Timing {
+    std::string name;
+    Source source;
+    double last;
+    double average;
+    uint64_t frame;
+    uint64_t sample;
+  };
+
+  // times the enclosing scope on the cpu
+  class Scope {
+   public:
+    Scope(std::string_view name);
+    ~Scope();
+
+   private:
+    std::string_view _name;
+    std::chrono::high_resolution_clock::time_point _start;
+  };
+
+  // names of the whole frame's timings, compared to tell cpu bound frames from gpu bound ones
+  static constexpr std::string_view CPU_FRAME = "cpu frame";
+  static constexpr std::string_view GPU_FRAME = "gpu frame";
+
+  static Profiler& get();
+
+  // timings of one sample accumulate, e.g. a section timed twice in a frame. samples default to
+  // the current frame, gpu timings pass the frame they measured since several can arrive at once
+  void record(std::string_view name,
+              Source source,
+              double milliseconds,
+              std::optional<uint64_t> sample = std::nullopt);
+  void endFrame();
+
+  std::vector<Timing> timings() const;
+  double average(std::string_view name, Source source) const;
+
+#if defined(PANCAKE_ENABLE_IMGUI)
+  void showWindow() const;
+#endif
+
+ private:
+  Profiler();
+
+  mutable std::mutex _mutex;
+  std::vector<Timing> _timings;
+  uint64_t _frame;
+};
+}  // namespace pancake
\ No newline at end of file
@@ -3,6 +3,7 @@ layout (location = 0) out vec4 frag_color;
 
 in vec2 tex_coords;
 
+// not in PancakeMaterial, ui, text and line draws set it per draw without a material
 uniform vec4 colour;
 uniform sampler2D tex;
 
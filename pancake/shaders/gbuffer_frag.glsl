@@ -7,7 +7,11 @@ in vec3 world_pos;
 in vec3 normal;
 in vec2 tex_coords;
 
-uniform vec4 colour;
+layout(std140) uniform PancakeMaterial
+{
+    vec4 colour;
+};
+
 uniform sampler2D tex;
 
 void main()
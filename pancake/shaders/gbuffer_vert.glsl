@@ -3,6 +3,7 @@ layout(location = 0) in vec4 m_pos;
 layout(location = 1) in vec4 m_normal;
 layout(location = 4) in vec2 m_tex_coords;
 layout(location = 6) in mat4 mvp;
+layout(location = 10) in mat4 model;
 
 out vec3 world_pos;
 out vec3 normal;
@@ -12,9 +13,8 @@ uniform vec4 tex_transform;
 
 void main()
 {
-    vec4 wpos = mvp * vec4(m_pos.xyz, 1.0);
-    gl_Position = wpos;
-    world_pos = wpos.xyz;
-    normal = m_normal.xyz;
+    gl_Position = mvp * vec4(m_pos.xyz, 1.0);
+    world_pos = (model * vec4(m_pos.xyz, 1.0)).xyz;
+    normal = normalize(transpose(inverse(mat3(model))) * m_normal.xyz);
     tex_coords = (m_tex_coords * tex_transform.zw) + tex_transform.xy;
 }
\ No newline at end of file
@@ -0,0 +1,55 @@
+#version 330 core
+layout (location = 0) out vec4 frag_color;
+
+in vec2 tex_coords;
+
+layout(std140) uniform PancakeLights
+{
+    uvec4 light_count;
+    vec4 light_grid;
+    vec4 light_positions[64];
+    vec4 light_colors[64];
+    uvec4 tile_light_masks[128];
+};
+
+uniform sampler2D albedo;
+uniform sampler2D normal;
+uniform sampler2D position;
+
+vec3 shade(int light, vec3 surface_pos, vec3 surface_normal)
+{
+    vec3 to_light = light_positions[light].xyz - surface_pos;
+    float radius = light_positions[light].w;
+    float dist = length(to_light);
+    float falloff = (0.0 < radius) ? clamp(1.0 - (dist / radius), 0.0, 1.0) : 1.0;
+    float lambert = max(dot(surface_normal, to_light / max(dist, 0.0001)), 0.0);
+    return light_colors[light].rgb * (lambert * falloff * falloff);
+}
+
+void main()
+{
+    vec4 base = texture(albedo, tex_coords);
+    vec3 surface_pos = texture(position, tex_coords).xyz;
+    vec3 surface_normal = normalize(texture(normal, tex_coords).xyz);
+
+    // only the lights binned into this pixel's tile are shaded
+    ivec2 tiles = ivec2(light_grid.xy);
+    ivec2 tile_xy = clamp(ivec2(gl_FragCoord.xy * light_grid.zw * light_grid.xy), ivec2(0),
+                          tiles - 1);
+    int tile = (tile_xy.y * tiles.x) + tile_xy.x;
+    uvec4 masks = tile_light_masks[tile / 2];
+    uvec2 mask = ((tile % 2) == 0) ? masks.xy : masks.zw;
+
+    vec3 lit = vec3(0.0);
+    for (int half_index = 0; half_index < 2; ++half_index) {
+        uint bits = mask[half_index];
+        for (int bit = 0; (bits != 0u) && (bit < 32); ++bit) {
+            if ((bits & 1u) != 0u) {
+                lit += shade((half_index * 32) + bit, surface_pos, surface_normal);
+            }
+            bits >>= 1;
+        }
+    }
+
+    frag_color = vec4(base.rgb * lit, base.a);
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) out vec4 frag_color;
+
+in vec2 tex_coords;
+in vec4 tint;
+
+uniform vec4 colour;
+uniform sampler2D tex;
+
+void main()
+{
+    frag_color = texture(tex, tex_coords).rgba * colour * tint;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 330 core
+layout(location = 0) in vec4 i_position_scale;
+layout(location = 1) in float i_rotation;
+layout(location = 2) in vec4 i_uv_rect;
+layout(location = 3) in vec4 i_colour;
+
+layout(std140) uniform PancakeCamera
+{
+    mat4 projection_transform;
+    mat4 view_transform;
+    vec4 view_position;
+};
+
+out vec2 tex_coords;
+out vec4 tint;
+
+void main()
+{
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 local = vec2(corner.x - 0.5, 0.5 - corner.y) * i_position_scale.zw;
+
+    float c = cos(i_rotation);
+    float s = sin(i_rotation);
+    vec2 world = i_position_scale.xy + (mat2(c, s, -s, c) * local);
+
+    gl_Position = projection_transform * view_transform * vec4(world, 0.0, 1.0);
+    tex_coords = (corner * i_uv_rect.zw) + i_uv_rect.xy;
+    tint = i_colour;
+}
\ No newline at end of file
@@ -7,13 +7,15 @@ using namespace pancake;
 
 const std::chrono::milliseconds THREAD_SLEEP_TIME(1);
 
-Dispatcher::Dispatcher() : _online(true), _num_done(0) {
+Dispatcher::Dispatcher()
+    : _online(true), _num_done(0), _tasks(), _next_task(0), _num_tasks_done(0) {
   const int num_threads = std::thread::hardware_concurrency() - 1;
   _thread_pool.reserve(num_threads);
   for (int i = 0; i < num_threads; ++i) {
     _thread_pool.emplace_back([this]() {
       while (_online) {
         consumeSystems();
+        consumeTasks();
         std::this_thread::sleep_for(THREAD_SLEEP_TIME);
       }
     });
@@ -49,6 +51,23 @@ void Dispatcher::execute(SystemGraph& system_graph) {
   ensure(_num_done == system_graph_size);
 }
 
+void Dispatcher::execute(std::span<const std::function<void()>> tasks) {
+  {
+    std::scoped_lock task_lock(_task_mutex);
+    ensure(_tasks.empty());
+    _tasks = tasks;
+    _next_task = 0;
+    _num_tasks_done = 0;
+  }
+
+  while (_num_tasks_done < tasks.size()) {
+    consumeTasks();
+  }
+
+  std::scoped_lock task_lock(_task_mutex);
+  _tasks = {};
+}
+
 void Dispatcher::consumeSystems() {
   SystemGraph::Node* node = nullptr;
 
@@ -102,4 +121,23 @@ void Dispatcher::consumeSystems() {
 
     node = next_node;
   }
+}
+
+void Dispatcher::consumeTasks() {
+  while (true) {
+    const std::function<void()>* task = nullptr;
+    {
+      std::scoped_lock task_lock(_task_mutex);
+      if (_next_task < _tasks.size()) {
+        task = &_tasks[_next_task++];
+      }
+    }
+
+    if (nullptr == task) {
+      return;
+    }
+
+    (*task)();
+    ++_num_tasks_done;
+  }
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #include "core/event_handler.hpp"
 
+#include "core/session_config.hpp"
+#include "null/null_event_handler.hpp"
 #include "sdl3/sdl3_event_handler.hpp"
 
 using namespace pancake;
 
-EventHandler* EventHandler::create() {
+EventHandler* EventHandler::create(const SessionConfig& config) {
+  if (const auto* rule = config.getRule<HeadlessRule>(); (nullptr != rule) && rule->value()) {
+    return new NullEventHandler(rule->frames());
+  }
   return new SDL3EventHandler();
 }
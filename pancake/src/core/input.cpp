@@ -1,8 +1,10 @@
 #include "core/input.hpp"
 
+#include "core/session_config.hpp"
 #include "input/gamepad.hpp"
 #include "input/input_action.hpp"
 #include "input/input_axis.hpp"
+#include "null/null_input.hpp"
 #include "sdl3/sdl3_input.hpp"
 
 using namespace pancake;
@@ -159,6 +161,9 @@ const Input::GamepadMap& Input::getGamepads() {
   return _gamepads;
 }
 
-Input* Input::create() {
+Input* Input::create(const SessionConfig& config) {
+  if (const auto* rule = config.getRule<HeadlessRule>(); (nullptr != rule) && rule->value()) {
+    return new NullInput();
+  }
   return new SDL3Input();
 }
\ No newline at end of file
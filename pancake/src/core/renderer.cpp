@@ -1,14 +1,28 @@
 #include "core/renderer.hpp"
 
+#include "core/dispatcher.hpp"
 #include "core/session.hpp"
+#include "core/session_config.hpp"
 #include "gl3/gl3_renderer.hpp"
 #include "graphics/atlassed_texture.hpp"
 #include "graphics/framebuffer.hpp"
 #include "graphics/mesh.hpp"
 #include "graphics/shader.hpp"
+#include "null/null_renderer.hpp"
 #include "resources/resources.hpp"
 #include "resources/texture_props_resource.hpp"
 #include "resources/tileset_resource.hpp"
+#include "util/fewi.hpp"
+#include "util/profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <string>
 
 using namespace pancake;
 
@@ -26,6 +40,11 @@ Renderer::Renderer()
       _render_size(512, 512),
       _screen_size(512, 512),
       _render_match_screen(false),
+      _dynamic_resolution(),
+      _render_scale(1.f),
+      _id(),
+      _submission_buffers_mutex(),
+      _submission_buffers(),
       _mesh_update_queue(),
       _texture_update_queue(),
       _tileset_update_queue(),
@@ -33,15 +52,154 @@ Renderer::Renderer()
       _tilesets(),
       _cameras(),
       _cam_draw_calls(),
-      _draw_calls() {}
+      _cam_draw_keys(),
+      _cam_draw_scratch(),
+      _cam_materials(),
+      _cam_input_overrides(),
+      _sprite_calls(),
+      _sprite_textures(),
+      _sprite_texture_inputs(),
+      _sprite_uv_rects(),
+      _sprite_atlas_inputs(),
+      _draw_queue(),
+      _time(0.f),
+      _frame_uniform_buffer(),
+      _camera_uniform_buffer(),
+      _camera_uniforms(),
+      _camera_uniform_data(),
+      _camera_uniform_stride(sizeof(CameraUniforms)),
+      _light_uniform_buffer(),
+      _light_uniforms(),
+      _light_uniform_data(),
+      _light_uniform_stride(sizeof(LightUniforms)) {
+  static std::atomic<uint64_t> next_id = 1;
+  _id = next_id++;
+}
+
+static const UniformId projection_transform_uniform("projection_transform");
+static const UniformId time_uniform("time");
+
+// frames a released framebuffer is kept around for reuse before it is destroyed
+static const uint32_t FRAMEBUFFER_POOL_FRAMES = 60;
+
+// enough camera draws per task to outweigh handing it to another thread
+static const uint32_t CAMERA_TASK_CALLS = 512;
+
+// a mesh level of detail is drawn while its error projects to less than this many pixels
+static const float MAX_LOD_PIXEL_ERROR = 1.f;
+// keeps instances at or behind the camera's plane at full detail
+static const float MIN_LOD_DEPTH = 1e-3f;
+
+static uint16_t packUnorm16(float value) {
+  return static_cast<uint16_t>(std::lround(std::clamp(value, 0.f, 1.f) * 65535.f));
+}
+
+static size_t alignedSize(size_t size, size_t alignment) {
+  return ((size + alignment - 1) / alignment) * alignment;
+}
+
+template <typename T>
+static void packUniforms(std::span<const T> uniforms, size_t stride, std::vector<std::byte>& data) {
+  data.assign(uniforms.size() * stride, std::byte(0));
+  for (size_t i = 0; i < uniforms.size(); ++i) {
+    std::memcpy(data.data() + (i * stride), static_cast<const void*>(&uniforms[i]), sizeof(T));
+  }
+}
+
+static void binLights(std::span<const LightInfo> lights,
+                      const Mat4f& view_projection,
+                      const Vec2i& framebuffer_size,
+                      LightUniforms& uniforms) {
+  constexpr int TILES_X = LightUniforms::TILES_X;
+  constexpr int TILES_Y = LightUniforms::TILES_Y;
+
+  if (LightUniforms::MAX_LIGHTS < lights.size()) {
+    // warns again whenever the overflow grows, so a scene that keeps adding lights is noticed
+    static size_t warned_count = 0;
+    if (warned_count < lights.size()) {
+      FEWI::warn() << "Only the first " << LightUniforms::MAX_LIGHTS << " of " << lights.size()
+                   << " lights will be binned, the rest are dropped!";
+      warned_count = lights.size();
+    }
+    lights = lights.first(LightUniforms::MAX_LIGHTS);
+  }
+
+  uniforms.light_count = Vec4u(static_cast<unsigned int>(lights.size()), 0, 0, 0);
+  uniforms.light_grid = Vec4f(static_cast<float>(TILES_X), static_cast<float>(TILES_Y),
+                              1.f / framebuffer_size.x(), 1.f / framebuffer_size.y());
+
+  for (size_t i = 0; i < lights.size(); ++i) {
+    const LightInfo& light = lights[i];
+    uniforms.light_positions[i] = Vec4f(light.position, light.radius);
+    uniforms.light_colors[i] = light.color;
+
+    int min_x = 0;
+    int min_y = 0;
+    int max_x = TILES_X - 1;
+    int max_y = TILES_Y - 1;
+
+    // conservative screen bounds of the light's box, lights reaching behind the camera cover all
+    if (0.f < light.radius) {
+      Vec2f ndc_min(std::numeric_limits<float>::max());
+      Vec2f ndc_max(std::numeric_limits<float>::lowest());
+      bool behind = false;
+      for (int corner = 0; (corner < 8) && !behind; ++corner) {
+        const Vec3f offset((corner & 1) ? light.radius : -light.radius,
+                           (corner & 2) ? light.radius : -light.radius,
+                           (corner & 4) ? light.radius : -light.radius);
+        const Vec4f clip = view_projection * Vec4f(light.position + offset, 1.f);
+        if (clip.w() <= 0.f) {
+          behind = true;
+        } else {
+          const Vec2f ndc(clip.x() / clip.w(), clip.y() / clip.w());
+          ndc_min = Vec2f((std::min)(ndc_min.x(), ndc.x()), (std::min)(ndc_min.y(), ndc.y()));
+          ndc_max = Vec2f((std::max)(ndc_max.x(), ndc.x()), (std::max)(ndc_max.y(), ndc.y()));
+        }
+      }
+
+      if (!behind) {
+        if ((ndc_max.x() < -1.f) || (ndc_max.y() < -1.f) || (1.f < ndc_min.x()) ||
+            (1.f < ndc_min.y())) {
+          continue;
+        }
+
+        const auto tile = [](float ndc, int tiles) {
+          return std::clamp(static_cast<int>(std::floor(((ndc * 0.5f) + 0.5f) * tiles)), 0,
+                            tiles - 1);
+        };
+        min_x = tile(ndc_min.x(), TILES_X);
+        min_y = tile(ndc_min.y(), TILES_Y);
+        max_x = tile(ndc_max.x(), TILES_X);
+        max_y = tile(ndc_max.y(), TILES_Y);
+      }
+    }
+
+    for (int y = min_y; y <= max_y; ++y) {
+      for (int x = min_x; x <= max_x; ++x) {
+        const int tile = (y * TILES_X) + x;
+        Vec4u& masks = uniforms.tile_light_masks[tile / 2];
+        masks.m[0][((tile % 2) * 2) + (i / 32)] |= (1u << (i % 32));
+      }
+    }
+  }
+}
 
 void Renderer::init() {
   FramebufferInfo info;
   info.render_targets[0].clear_colour = Vec4f::ones();
-  info.size = _render_size;
+  info.size = scaledRenderSize();
   info.num_targets = 1;
   _framebuffers.emplace(GUID::null, createFramebuffer(GUID::null, info));
 
+  _frame_uniform_buffer = createUniformBuffer();
+  _camera_uniform_buffer = createUniformBuffer();
+
+  const size_t alignment = (std::max)(uniformBufferOffsetAlignment(), size_t(1));
+  _camera_uniform_stride = alignedSize(sizeof(CameraUniforms), alignment);
+
+  _light_uniform_buffer = createUniformBuffer();
+  _light_uniform_stride = alignedSize(sizeof(LightUniforms), alignment);
+
   MaterialResource defaultMatRes("", GUID::null);
   defaultMatRes.setShader(getDefaultShader()->guid());
   defaultMatRes.addInput(ShaderInput("colour", Vec4f::ones()));
@@ -58,6 +216,16 @@ void Renderer::queueTextureUpdate(const GUID& guid) {
   _texture_update_queue.emplace_back(guid);
 }
 
+void Renderer::queueTextureUpdate(const TextureRef& texture) {
+  if (texture.tile < 0) {
+    if (!getTexture(texture.texture).has_value()) {
+      queueTextureUpdate(texture.texture);
+    }
+  } else if (!getTileset(texture.texture).has_value()) {
+    queueTilesetUpdate(texture.texture);
+  }
+}
+
 void Renderer::queueTilesetUpdate(const GUID& guid) {
   _tileset_update_queue.emplace_back(guid);
 }
@@ -82,6 +250,32 @@ OptTextureConstRef Renderer::getTexture(const GUID& guid) const {
   return texture;
 }
 
+const Texture& Renderer::resolveTexture(const TextureRef& texture, Vec4f& transform) const {
+  OptTextureConstRef texture_opt;
+  OptTilesetConstRef tileset_opt;
+
+  if (const auto framebuffer_opt = getFramebuffer(texture.texture); framebuffer_opt.has_value()) {
+    texture_opt = framebuffer_opt.value().get().texture(texture.tile < 0 ? 0 : texture.tile);
+  }
+
+  if (!texture_opt.has_value()) {
+    if (texture.tile < 0) {
+      texture_opt = getTexture(texture.texture);
+    } else {
+      tileset_opt = getTileset(texture.texture);
+      if (tileset_opt.has_value()) {
+        texture_opt = getTexture(tileset_opt.value().get().getTextureProps());
+      }
+    }
+  }
+
+  const Texture& resolved = texture_opt.has_value() ? texture_opt.value().get() : getBlankTexture();
+  transform = tileset_opt.has_value()
+                  ? tileset_opt.value().get().genTransform(texture.tile, resolved.transform())
+                  : resolved.transform();
+  return resolved;
+}
+
 OptTilesetConstRef Renderer::getTileset(const GUID& guid) const {
   OptTilesetConstRef tileset;
   if (_tilesets.contains(guid)) {
@@ -120,6 +314,35 @@ const Vec2i& Renderer::screenSize() const {
   return _screen_size;
 }
 
+void Renderer::enableDynamicResolution(double target_milliseconds,
+                                       float min_scale,
+                                       float max_scale) {
+  _dynamic_resolution.emplace(target_milliseconds, min_scale, max_scale);
+  _render_scale = _dynamic_resolution->scale();
+}
+
+void Renderer::disableDynamicResolution() {
+  _dynamic_resolution.reset();
+  _render_scale = 1.f;
+}
+
+float Renderer::renderScale() const {
+  return _render_scale;
+}
+
+Vec2i Renderer::scaledRenderSize() const {
+  return Vec2i((std::max)(static_cast<int>(std::round(_render_size.x() * _render_scale)), 1),
+               (std::max)(static_cast<int>(std::round(_render_size.y() * _render_scale)), 1));
+}
+
+Vec2i Renderer::layoutSize(const FramebufferInfo& framebuffer_info) const {
+  if ((0 < framebuffer_info.relative_size.x()) || (0 < framebuffer_info.relative_size.y())) {
+    const Vec2f render_size = _render_size;
+    return render_size.mask(framebuffer_info.relative_size);
+  }
+  return framebuffer_info.size;
+}
+
 Vec2f Renderer::screenToRenderPosition(const Vec2f& screen_pos) const {
   Vec2f pos = screen_pos;
 
@@ -141,27 +364,169 @@ Vec2f Renderer::screenToRenderPosition(const Vec2f& screen_pos) const {
 
 void Renderer::submitFramebuffer(const GUID& guid, const FramebufferInfo& framebuffer_info) {
   if (const auto it = _framebuffers.find(guid); it != _framebuffers.end()) {
-    it->second->update(framebuffer_info);
-    it->second->setActiveFlag();
+    // a framebuffer aliased by another guid has to be swapped out rather than changed under it
+    if ((1 == it->second.use_count()) || it->second->matches(framebuffer_info)) {
+      it->second->update(framebuffer_info);
+    } else {
+      releaseFramebuffer(std::move(it->second));
+      it->second = acquireFramebuffer(guid, framebuffer_info);
+    }
   } else {
-    std::unique_ptr<Framebuffer>& framebuffer =
-        _framebuffers.emplace(guid, createFramebuffer(guid, framebuffer_info)).first->second;
-    framebuffer->setActiveFlag();
+    _framebuffers.emplace(guid, acquireFramebuffer(guid, framebuffer_info));
   }
+  _framebuffer_infos.insert_or_assign(guid, framebuffer_info);
+
   if (0 <= framebuffer_info.blit_priority) {
     _blitting_framebuffers.emplace(framebuffer_info.blit_priority, guid);
   }
 }
 
+Ptr<Framebuffer> Renderer::acquireFramebuffer(const GUID& guid, const FramebufferInfo& info) {
+  for (auto it = _framebuffer_pool.begin(); it != _framebuffer_pool.end(); ++it) {
+    if (it->framebuffer->matches(info)) {
+      Ptr<Framebuffer> framebuffer = std::move(it->framebuffer);
+      _framebuffer_pool.erase(it);
+      framebuffer->update(info);
+      return framebuffer;
+    }
+  }
+  return createFramebuffer(guid, info);
+}
+
+void Renderer::releaseFramebuffer(Ptr<Framebuffer> framebuffer) {
+  if ((nullptr != framebuffer) && (1 == framebuffer.use_count())) {
+    _framebuffer_pool.emplace_back(std::move(framebuffer), 0);
+  }
+}
+
+void Renderer::planFramebuffers() {
+  const std::vector<DrawQueue::Batch>& batches = _draw_queue.batches();
+  const SlotTable<GUID>& framebuffers = _draw_queue.framebuffers();
+
+  for (uint32_t i = 0; i < batches.size(); ++i) {
+    const DrawQueue::Batch& batch = batches[i];
+    const GUID& target = framebuffers[batch.framebuffer];
+    {
+      FramebufferPass& pass = _framebuffer_passes[target];
+      pass.first_batch = (std::min)(pass.first_batch, i);
+      pass.last_batch = (std::max)(pass.last_batch, i);
+      pass.written = true;
+    }
+
+    for (const ShaderInput& input : _draw_queue.inputs()[batch.inputs]->inputs()) {
+      if (const TextureRef* texture = input.getTextureRef();
+          (nullptr != texture) && (texture->texture != target) &&
+          _framebuffers.contains(texture->texture)) {
+        FramebufferPass& read_pass = _framebuffer_passes[texture->texture];
+        read_pass.last_batch = (std::max)(read_pass.last_batch, i);
+
+        std::vector<GUID>& reads = _framebuffer_passes[target].reads;
+        if (std::find(reads.begin(), reads.end(), texture->texture) == reads.end()) {
+          reads.push_back(texture->texture);
+        }
+      }
+    }
+  }
+
+  // only transient framebuffers can be culled, anything else may be read back or next frame
+  std::vector<GUID> live = {GUID::null};
+  for (const auto& [priority, guid] : _blitting_framebuffers) {
+    _framebuffer_passes[guid].last_batch = std::numeric_limits<uint32_t>::max();
+    live.push_back(guid);
+  }
+  for (const auto& [guid, info] : _framebuffer_infos) {
+    if (!info.transient) {
+      live.push_back(guid);
+    }
+  }
+  while (!live.empty()) {
+    FramebufferPass& pass = _framebuffer_passes[live.back()];
+    live.pop_back();
+    if (!pass.live) {
+      pass.live = true;
+      live.insert(live.end(), pass.reads.begin(), pass.reads.end());
+    }
+  }
+
+  // transient targets are handed out again every frame, passes that don't overlap share one
+  std::vector<std::pair<uint32_t, GUID>> transients;
+  for (const auto& [guid, info] : _framebuffer_infos) {
+    if (info.transient) {
+      const auto it = _framebuffers.find(guid);
+      releaseFramebuffer(std::move(it->second));
+      _framebuffers.erase(it);
+      transients.emplace_back(_framebuffer_passes[guid].first_batch, guid);
+    }
+  }
+  std::sort(transients.begin(), transients.end());
+
+  std::vector<std::pair<Ptr<Framebuffer>, uint32_t>> shared;
+  for (const auto& [first_batch, guid] : transients) {
+    const FramebufferPass& pass = _framebuffer_passes[guid];
+    if (!pass.live) {
+      continue;
+    }
+
+    // targets that aren't cleared on begin keep whatever the previous pass drew, so only auto
+    // cleared ones can take over another pass's framebuffer
+    const FramebufferInfo& info = _framebuffer_infos.at(guid);
+    const bool shareable = pass.written && info.auto_clear;
+    Ptr<Framebuffer> framebuffer;
+    if (shareable) {
+      for (auto& [candidate, last_batch] : shared) {
+        if ((last_batch < pass.first_batch) && candidate->matches(info)) {
+          framebuffer = candidate;
+          last_batch = pass.last_batch;
+          break;
+        }
+      }
+    }
+
+    if (nullptr == framebuffer) {
+      framebuffer = acquireFramebuffer(guid, info);
+      // targets that are only read keep their clear colour, so they can't be shared
+      if (shareable) {
+        shared.emplace_back(framebuffer, pass.last_batch);
+      }
+    }
+    _framebuffers.emplace(guid, std::move(framebuffer));
+  }
+
+  // culled targets are never drawn to or read, any framebuffer of the right layout will do
+  for (const auto& [first_batch, guid] : transients) {
+    if (!_framebuffer_passes[guid].live) {
+      const FramebufferInfo& info = _framebuffer_infos.at(guid);
+      Ptr<Framebuffer> framebuffer;
+      for (const auto& [candidate, last_batch] : shared) {
+        if (candidate->matches(info)) {
+          framebuffer = candidate;
+          break;
+        }
+      }
+      _framebuffers.emplace(guid, (nullptr != framebuffer) ? std::move(framebuffer)
+                                                            : acquireFramebuffer(guid, info));
+    }
+  }
+
+  // targets nobody draws to this frame are cleared up front, and only once after being drawn to
+  for (const auto& [guid, framebuffer] : _framebuffers) {
+    if (const auto it = _framebuffer_passes.find(guid);
+        (it == _framebuffer_passes.end()) || !it->second.written) {
+      framebuffer->clearIfDrawn();
+    }
+  }
+}
+
 void Renderer::submitCamera(const Transform2D& transform, const Camera2D& camera) {
   _cameras.emplace_back(transform.inverseMatrix3D(), Vec3f(transform.translation(), 0.f),
-                        Vec2f::ones(), camera.mask, camera.framebuffer, 0.01f, 1000.f, 0.f, false);
+                        Vec2f::ones(), camera.mask, camera.framebuffer, 0.01f, 1000.f, 0.f, false,
+                        false);
 }
 
 void Renderer::submitCamera(const Transform3D& transform, const Camera3D& camera) {
   _cameras.emplace_back(transform.inverseMatrix(), transform.translation(), Vec2f::ones(),
                         camera.mask, camera.framebuffer, camera.near, camera.far, camera.fov,
-                        camera.perspective);
+                        camera.perspective, camera.occlusion_culling);
 }
 
 void Renderer::submitMaterial(const GUID& guid, Resources& resources) {
@@ -184,7 +549,68 @@ void Renderer::submit(const CameraMask& mask,
                       const GUID& mesh,
                       const Mat4f& model,
                       const Entity& entity) {
-  _cam_draw_calls[mask][material][input_overrides][mesh].emplace_back(model, entity);
+  submit(mask, material, ShaderInputBlock::intern(input_overrides), mesh, model, entity);
+}
+
+void Renderer::submit(const CameraMask& mask,
+                      const GUID& material,
+                      const Ptr<const ShaderInputBlock>& input_overrides,
+                      const GUID& mesh,
+                      const Mat4f& model,
+                      const Entity& entity) {
+  submissionBuffer().cam_draw_calls.emplace_back(mask, material, input_overrides, mesh, model,
+                                                 entity);
+}
+
+void Renderer::submitRetained(const GUID& id,
+                              const CameraMask& mask,
+                              const GUID& material,
+                              const Ptr<const ShaderInputBlock>& input_overrides,
+                              const GUID& mesh,
+                              const Mat4f& model,
+                              const Entity& entity) {
+  submissionBuffer().retained_cam_draw_calls.emplace_back(
+      id, CameraSubmission(mask, material, input_overrides, mesh, model, entity));
+}
+
+void Renderer::submitRetained(const GUID& id,
+                              int stage,
+                              const GUID& framebuffer,
+                              const DrawOptions& options,
+                              const GUID& shader,
+                              const Ptr<const ShaderInputBlock>& inputs,
+                              const GUID& mesh,
+                              const CommonPerInstanceData& cpid) {
+  submissionBuffer().retained_draw_calls.emplace_back(
+      id, DrawSubmission(stage, framebuffer, options, shader, inputs, mesh, cpid));
+}
+
+void Renderer::submitRetainedRelease(const GUID& id) {
+  submissionBuffer().retained_releases.emplace_back(id);
+}
+
+void Renderer::submitMeshUpdate(const GUID& guid,
+                                std::vector<Vertex> vertices,
+                                std::vector<unsigned int> indices,
+                                const VertexLayout& layout) {
+  submissionBuffer().mesh_updates.emplace_back(guid, std::move(vertices), std::move(indices),
+                                               layout);
+}
+
+void Renderer::submitMeshRelease(const GUID& guid) {
+  submissionBuffer().mesh_releases.emplace_back(guid);
+}
+
+void Renderer::submitSprite(const CameraMask& mask,
+                            const TextureRef& texture,
+                            const Transform2D& transform,
+                            uint32_t colour) {
+  SpriteInstanceData sprite;
+  sprite.position = transform.translation();
+  sprite.scale = transform.scale();
+  sprite.rotation = transform.rotation();
+  sprite.colour = colour;
+  submissionBuffer().sprite_calls.emplace_back(mask, texture, sprite);
 }
 
 void Renderer::submit(int stage,
@@ -194,85 +620,558 @@ void Renderer::submit(int stage,
                       const std::set<ShaderInput>& inputs,
                       const GUID& mesh,
                       const CommonPerInstanceData& cpid) {
-  _draw_calls[stage][framebuffer][options][shader][inputs][mesh].push_back(cpid);
-  _mesh_update_queue.emplace(mesh);
-  _shader_update_queue.emplace(shader);
+  submit(stage, framebuffer, options, shader, ShaderInputBlock::intern(inputs), mesh, cpid);
+}
 
-  for (const ShaderInput& input : inputs) {
-    input.submitted(*this);
+void Renderer::submit(int stage,
+                      const GUID& framebuffer,
+                      const DrawOptions& options,
+                      const GUID& shader,
+                      const Ptr<const ShaderInputBlock>& inputs,
+                      const GUID& mesh,
+                      const CommonPerInstanceData& cpid) {
+  submissionBuffer().draw_calls.emplace_back(stage, framebuffer, options, shader, inputs, mesh,
+                                             cpid);
+}
+
+Renderer::SubmissionBuffer& Renderer::submissionBuffer() {
+  thread_local uint64_t owner = 0;
+  thread_local SubmissionBuffer* buffer = nullptr;
+  if (owner != _id) {
+    std::lock_guard lock(_submission_buffers_mutex);
+    buffer = _submission_buffers.emplace_back(std::make_unique<SubmissionBuffer>()).get();
+    owner = _id;
   }
+  return *buffer;
 }
 
-void Renderer::preRender(Session& session, Resources& resources) {
-  float time = session.time();
-  Mat4f projection;
+void Renderer::mergeSubmissionBuffers() {
+  std::lock_guard lock(_submission_buffers_mutex);
+  for (const std::unique_ptr<SubmissionBuffer>& buffer : _submission_buffers) {
+    for (const MeshSubmission& update : buffer->mesh_updates) {
+      auto it = _meshes.find(update.guid);
+      if (it == _meshes.end()) {
+        it = _meshes.emplace(update.guid, createMesh(update.guid).release()).first;
+      }
+      _retained_lods_dirty |= !it->second->lods().empty();
+      it->second->update(update.vertices, update.indices, update.layout);
+    }
+    buffer->mesh_updates.clear();
+
+    for (const GUID& guid : buffer->mesh_releases) {
+      _meshes.erase(guid);
+    }
+    buffer->mesh_releases.clear();
+
+    for (auto& [id, call] : buffer->retained_cam_draw_calls) {
+      const auto [it, inserted] = _retained_cam_calls.try_emplace(id);
+      const CameraSubmission& prev = it->second.call;
+      if (inserted || (prev.mask != call.mask) || (prev.material != call.material) ||
+          (prev.input_overrides != call.input_overrides) || (prev.mesh != call.mesh)) {
+        _retained_dirty = true;
+      } else {
+        _retained_patches.push_back(id);
+      }
+      it->second.call = std::move(call);
+    }
+    buffer->retained_cam_draw_calls.clear();
+
+    for (auto& [id, call] : buffer->retained_draw_calls) {
+      const auto [it, inserted] = _retained_draw_calls.try_emplace(id);
+      const DrawSubmission& prev = it->second.call;
+      if (inserted || (prev.stage != call.stage) || (prev.framebuffer != call.framebuffer) ||
+          (prev.options != call.options) || (prev.shader != call.shader) ||
+          (prev.inputs != call.inputs) || (prev.mesh != call.mesh)) {
+        _retained_dirty = true;
+      } else {
+        _retained_patches.push_back(id);
+      }
+      it->second.call = std::move(call);
+    }
+    buffer->retained_draw_calls.clear();
+
+    for (const GUID& id : buffer->retained_releases) {
+      if ((0 < _retained_cam_calls.erase(id)) || (0 < _retained_draw_calls.erase(id))) {
+        _retained_dirty = true;
+      }
+    }
+    buffer->retained_releases.clear();
+
+    for (const CameraSubmission& call : buffer->cam_draw_calls) {
+      _cam_draw_calls.emplace_back(call.mask, _cam_materials.get(call.material),
+                                   _cam_input_overrides.get(call.input_overrides), call.mesh,
+                                   call.model, call.entity);
+    }
+    buffer->cam_draw_calls.clear();
+
+    _draw_calls.insert(_draw_calls.end(), std::make_move_iterator(buffer->draw_calls.begin()),
+                       std::make_move_iterator(buffer->draw_calls.end()));
+    buffer->draw_calls.clear();
+
+    for (const SpriteSubmission& call : buffer->sprite_calls) {
+      _sprite_calls.emplace_back(call.mask, _sprite_textures.get(call.texture), call.sprite);
+    }
+    buffer->sprite_calls.clear();
+  }
+}
+
+uint32_t Renderer::selectLod(const Mesh* mesh,
+                             uint32_t camera,
+                             const Mat4f& mvp,
+                             const Mat4f& model) const {
+  if ((nullptr == mesh) || mesh->lods().empty()) {
+    return 0;
+  }
+
+  // pixels a unit of the mesh's space covers at its origin, whose clip space w is its depth under
+  // a perspective projection and 1 under an orthographic one
+  const Vec3f scale = model.getScale();
+  const float max_scale = (std::max)({scale.x(), scale.y(), scale.z()});
+  const float pixels_per_unit =
+      (_camera_lod_scales[camera] * max_scale) / (std::max)(mvp[3][3], MIN_LOD_DEPTH);
+  return selectMeshLod(mesh->lods(), pixels_per_unit, MAX_LOD_PIXEL_ERROR);
+}
+
+void Renderer::expandCameraDrawCalls(std::span<const CameraDrawCall> calls,
+                                     const SlotTable<GUID>& materials,
+                                     const CameraTask& task,
+                                     CameraPackets& packets) const {
+  const CameraInfo& cam_info = _cameras[task.camera];
   DrawOptions draw_options;
-  std::set<ShaderInput> inputs;
   CommonPerInstanceData cpid;
+  const Mesh* mesh = nullptr;
+  GUID mesh_guid = GUID::null;
 
-  const auto process = [&](const CameraInfo& cam_info, const Material& material,
-                           const auto& mesh_models) {
-    const GUID& shader = material.getShader();
-    int stage = material.getStage();
-    for (const auto& [mesh, models] : mesh_models) {
-      for (const auto& [model, entity] : models) {
-        cpid.mvp_transform = projection * cam_info.view * model;
-        cpid.model_transform = model;
-        cpid.entity = entity;
-        submit(stage, cam_info.fb, draw_options, shader, inputs, mesh, cpid);
+  const auto process = [&](const Material& material, std::span<const SortKey> run,
+                           const Ptr<const ShaderInputBlock>& inputs) {
+    CameraPacketGroup& group = packets.groups.emplace_back(
+        material.getStage(), draw_options, material.getShader(), inputs, material.guid(), 0);
+    for (const SortKey& sort_key : run) {
+      const CameraDrawCall& call = calls[sort_key.index];
+      if ((cam_info.mask & call.mask) != CameraMask::empty()) {
+        cpid.mvp_transform = _camera_view_projections[task.camera] * call.model;
+        cpid.model_transform = call.model;
+        cpid.entity = call.entity;
+        if ((nullptr == mesh) || (mesh_guid != call.mesh)) {
+          const auto it = _meshes.find(call.mesh);
+          mesh = (it != _meshes.end()) ? it->second.get() : nullptr;
+          mesh_guid = call.mesh;
+        }
+        packets.calls.push_back(sort_key.index);
+        packets.cpids.push_back(cpid);
+        packets.lods.push_back(selectLod(mesh, task.camera, cpid.mvp_transform, call.model));
+        ++group.num_packets;
       }
     }
   };
 
-  for (const CameraInfo& cam_info : _cameras) {
-    if (const auto it = _framebuffers.find(cam_info.fb); it != _framebuffers.end()) {
-      projection = cam_info.projection(*(it->second));
-      for (const auto& [draw_mask, draw_calls] : _cam_draw_calls) {
-        if ((cam_info.mask & draw_mask) != CameraMask::empty()) {
-          for (const auto& [mat_id, inputs_mesh_models] : draw_calls) {
-            if (const auto& mat_opt = getMaterial(mat_id); mat_opt.has_value()) {
-              const Material& material = mat_opt.value();
-              draw_options.depth_test = material.getDepthTest();
-
-              for (const auto& [input_overrides, mesh_models] : inputs_mesh_models) {
-                inputs = input_overrides;
-
-                const auto& mat_inputs = material.getInputs();
-                inputs.insert(mat_inputs.begin(), mat_inputs.end());
-
-                inputs.insert(ShaderInput("projection_transform", projection));
-                inputs.insert(ShaderInput("time", time));
-
-                if (std::string_view view_input_name = material.getViewInputName();
-                    !view_input_name.empty()) {
-                  inputs.insert(
-                      ShaderInput(std::string(view_input_name) + "_position", cam_info.position));
-                  inputs.insert(
-                      ShaderInput(std::string(view_input_name) + "_transform", cam_info.view));
-                }
-
-                if (std::string_view light_pass_input_name = material.getLightPassInputName();
-                    !light_pass_input_name.empty()) {
-                  auto light_input_it = inputs.end();
-                  for (const LightInfo& light : _lights) {
-                    if (light_input_it != inputs.end()) {
-                      inputs.erase(light_input_it);
-                    }
-                    light_input_it =
-                        inputs.emplace(ShaderInput(light_pass_input_name, light)).first;
-
-                    process(cam_info, material, mesh_models);
-                  }
-                } else {
-                  process(cam_info, material, mesh_models);
-                }
-              }
-            }
-          }
+  for (uint32_t run_index = task.first_run; run_index < task.last_run; ++run_index) {
+    const std::span<const SortKey> run(_cam_draw_keys.data() + _cam_draw_runs[run_index],
+                                       _cam_draw_runs[run_index + 1] - _cam_draw_runs[run_index]);
+
+    bool visible = false;
+    for (const SortKey& sort_key : run) {
+      visible |= ((cam_info.mask & calls[sort_key.index].mask) != CameraMask::empty());
+    }
+    if (!visible) {
+      continue;
+    }
+
+    const CameraDrawCall& first_call = calls[run.front().index];
+    if (const auto& mat_opt = getMaterial(materials[first_call.material]); mat_opt.has_value()) {
+      const Material& material = mat_opt.value();
+      draw_options.depth_test = material.getDepthTest();
+
+      // light passes expand into one group per light, each with its own block
+      for (uint32_t block = _cam_run_blocks[run_index]; block < _cam_run_blocks[run_index + 1];
+           ++block) {
+        process(material, run, _cam_run_inputs[block]);
+      }
+    }
+  }
+}
+
+void Renderer::internCameraRunInputs(std::span<const CameraDrawCall> calls,
+                                     const SlotTable<GUID>& materials,
+                                     const ShaderInputsSlotTable& input_overrides,
+                                     uint32_t num_runs) {
+  _cam_run_inputs.clear();
+  _cam_run_blocks.clear();
+  std::set<ShaderInput> inputs;
+  for (uint32_t run = 0; run < num_runs; ++run) {
+    _cam_run_blocks.push_back(static_cast<uint32_t>(_cam_run_inputs.size()));
+
+    const CameraDrawCall& first_call = calls[_cam_draw_keys[_cam_draw_runs[run]].index];
+    const auto& mat_opt = getMaterial(materials[first_call.material]);
+    if (!mat_opt.has_value()) {
+      continue;
+    }
+
+    const Material& material = mat_opt.value();
+    const auto overrides = input_overrides[first_call.input_overrides]->inputs();
+    inputs.clear();
+    inputs.insert(overrides.begin(), overrides.end());
+
+    const auto& mat_inputs = material.getTextureInputs();
+    inputs.insert(mat_inputs.begin(), mat_inputs.end());
+
+    const auto shader_it = _shaders.find(material.getShader());
+    const bool binned_lights =
+        (shader_it != _shaders.end()) &&
+        (nullptr != shader_it->second->getUniformBlockLayout(UniformBlock::Lights));
+
+    if (std::string_view light_pass_input_name = material.getLightPassInputName();
+        !light_pass_input_name.empty() && !binned_lights) {
+      auto light_input_it = inputs.end();
+      for (const LightInfo& light : _lights) {
+        if (light_input_it != inputs.end()) {
+          inputs.erase(light_input_it);
+        }
+        light_input_it = inputs.emplace(ShaderInput(light_pass_input_name, light)).first;
+        _cam_run_inputs.push_back(ShaderInputBlock::intern(inputs));
+      }
+    } else {
+      _cam_run_inputs.push_back(ShaderInputBlock::intern(inputs));
+    }
+  }
+  _cam_run_blocks.push_back(static_cast<uint32_t>(_cam_run_inputs.size()));
+}
+
+void Renderer::queueCameraDrawCalls(Dispatcher& dispatcher,
+                                    std::span<const CameraDrawCall> calls,
+                                    const SlotTable<GUID>& materials,
+                                    const ShaderInputsSlotTable& input_overrides,
+                                    std::span<RetainedCameraCall* const> retained) {
+  _cam_draw_keys.clear();
+  _cam_draw_keys.reserve(calls.size());
+  for (uint32_t i = 0; i < calls.size(); ++i) {
+    const CameraDrawCall& call = calls[i];
+    _cam_draw_keys.emplace_back(
+        (static_cast<uint64_t>(call.material) << 32) | call.input_overrides, i);
+  }
+  radixSort(_cam_draw_keys, _cam_draw_scratch);
+
+  // runs share a material and input overrides, so each expands into one group of packets
+  _cam_draw_runs.clear();
+  for (uint32_t i = 0; i < _cam_draw_keys.size(); ++i) {
+    if ((0 == i) || (_cam_draw_keys[i].key != _cam_draw_keys[i - 1].key)) {
+      _cam_draw_runs.push_back(i);
+    }
+  }
+  const uint32_t num_runs = static_cast<uint32_t>(_cam_draw_runs.size());
+  _cam_draw_runs.push_back(static_cast<uint32_t>(_cam_draw_keys.size()));
+
+  // blocks are interned here once per run rather than by every camera's tasks expanding it
+  internCameraRunInputs(calls, materials, input_overrides, num_runs);
+
+  // each camera's runs are split into tasks of roughly CAMERA_TASK_CALLS calls
+  _cam_tasks.clear();
+  for (uint32_t camera = 0; camera < _cameras.size(); ++camera) {
+    if (!_framebuffers.contains(_cameras[camera].fb)) {
+      continue;
+    }
+
+    uint32_t first_run = 0;
+    for (uint32_t run = 0; run < num_runs; ++run) {
+      if ((_cam_draw_runs[run + 1] - _cam_draw_runs[first_run]) >= CAMERA_TASK_CALLS) {
+        _cam_tasks.emplace_back(camera, first_run, run + 1);
+        first_run = run + 1;
+      }
+    }
+    if (first_run < num_runs) {
+      _cam_tasks.emplace_back(camera, first_run, num_runs);
+    }
+  }
+
+  if (_cam_packets.size() < _cam_tasks.size()) {
+    _cam_packets.resize(_cam_tasks.size());
+  }
+
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(_cam_tasks.size());
+  for (size_t i = 0; i < _cam_tasks.size(); ++i) {
+    tasks.emplace_back([&, i]() {
+      CameraPackets& packets = _cam_packets[i];
+      packets.groups.clear();
+      packets.calls.clear();
+      packets.cpids.clear();
+      packets.lods.clear();
+      expandCameraDrawCalls(calls, materials, _cam_tasks[i], packets);
+    });
+  }
+  dispatcher.execute(tasks);
+
+  // merged in task order, so the queue sees packets exactly as a serial expansion pushes them
+  for (size_t i = 0; i < _cam_tasks.size(); ++i) {
+    const uint32_t camera = _cam_tasks[i].camera;
+    const GUID& fb = _cameras[camera].fb;
+    const CameraPackets& packets = _cam_packets[i];
+
+    size_t packet = 0;
+    for (const CameraPacketGroup& group : packets.groups) {
+      for (const size_t end = packet + group.num_packets; packet < end; ++packet) {
+        const uint32_t call = packets.calls[packet];
+        if (retained.empty()) {
+          _draw_queue.push(group.stage, fb, group.options, group.shader, group.inputs,
+                           calls[call].mesh, packets.cpids[packet], camera, group.material,
+                           packets.lods[packet]);
+        } else {
+          retained[call]->packets.push_back(_draw_queue.pushRetained(
+              group.stage, fb, group.options, group.shader, group.inputs, calls[call].mesh,
+              packets.cpids[packet], camera, group.material, packets.lods[packet]));
         }
       }
     }
   }
+}
+
+Renderer::RetainedMaterial Renderer::retainedMaterial(const GUID& guid) {
+  RetainedMaterial state;
+  if (const auto& mat_opt = getMaterial(guid); mat_opt.has_value()) {
+    const Material& material = mat_opt.value();
+    const auto shader_it = _shaders.find(material.getShader());
+    state.loaded = true;
+    state.shader = material.getShader();
+    state.stage = material.getStage();
+    state.depth_test = material.getDepthTest();
+    state.binned_lights =
+        (shader_it != _shaders.end()) &&
+        (nullptr != shader_it->second->getUniformBlockLayout(UniformBlock::Lights));
+    state.light_pass_input_name = material.getLightPassInputName();
+    state.texture_inputs = material.getTextureInputs();
+  }
+  return state;
+}
+
+bool Renderer::retainedMaterialMatches(const GUID& guid, const RetainedMaterial& state) const {
+  const auto& mat_opt = getMaterial(guid);
+  if (!mat_opt.has_value()) {
+    return !state.loaded;
+  }
+
+  const Material& material = mat_opt.value();
+  const auto shader_it = _shaders.find(material.getShader());
+  const bool binned_lights =
+      (shader_it != _shaders.end()) &&
+      (nullptr != shader_it->second->getUniformBlockLayout(UniformBlock::Lights));
+  return state.loaded && (state.shader == material.getShader()) &&
+         (state.stage == material.getStage()) && (state.depth_test == material.getDepthTest()) &&
+         (state.binned_lights == binned_lights) &&
+         (state.light_pass_input_name == material.getLightPassInputName()) &&
+         (state.texture_inputs == material.getTextureInputs());
+}
+
+void Renderer::patchRetained() {
+  // a moved camera leaves every packet in place, only their instances and levels of detail change
+  bool moved = false;
+  for (uint32_t camera = 0; camera < _cameras.size(); ++camera) {
+    moved |= !(_camera_view_projections[camera] == _retained_view_projections[camera]) ||
+             (_camera_lod_scales[camera] != _retained_lod_scales[camera]);
+  }
+
+  const auto patch = [this](const RetainedCameraCall& retained) {
+    const CameraSubmission& call = retained.call;
+    const auto mesh_it = _meshes.find(call.mesh);
+    const Mesh* mesh = (mesh_it != _meshes.end()) ? mesh_it->second.get() : nullptr;
+    CommonPerInstanceData cpid;
+    cpid.model_transform = call.model;
+    cpid.entity = call.entity;
+    for (const uint32_t packet : retained.packets) {
+      const uint32_t camera = _draw_queue.retainedCamera(packet);
+      cpid.mvp_transform = _camera_view_projections[camera] * call.model;
+      _draw_queue.setRetainedLod(packet, selectLod(mesh, camera, cpid.mvp_transform, call.model));
+      _draw_queue.patchRetained(packet, cpid);
+    }
+  };
+
+  if (moved) {
+    for (const auto& [_, retained] : _retained_cam_calls) {
+      patch(retained);
+    }
+    _retained_view_projections = _camera_view_projections;
+    _retained_lod_scales = _camera_lod_scales;
+  }
+
+  for (const GUID& id : _retained_patches) {
+    if (const auto it = _retained_cam_calls.find(id); it != _retained_cam_calls.end()) {
+      if (!moved) {
+        patch(it->second);
+      }
+    } else if (const auto it = _retained_draw_calls.find(id); it != _retained_draw_calls.end()) {
+      _draw_queue.patchRetained(it->second.packet, it->second.call.cpid);
+    }
+  }
+  _retained_patches.clear();
+}
+
+void Renderer::queueRetained(Dispatcher& dispatcher) {
+  if (!_retained_dirty && _retained_cam_calls.empty() && _retained_draw_calls.empty()) {
+    return;
+  }
+
+  const auto retained_camera = [this](uint32_t camera) {
+    const CameraInfo& cam_info = _cameras[camera];
+    return RetainedCamera{cam_info.fb, cam_info.mask, _framebuffers.contains(cam_info.fb)};
+  };
+
+  // the queued packets stay valid while nothing they were expanded from has changed, moved draws
+  // and cameras only need their instances patched
+  bool unchanged =
+      !_retained_dirty && !_retained_lods_dirty && (_retained_cameras.size() == _cameras.size());
+  for (uint32_t camera = 0; unchanged && (camera < _cameras.size()); ++camera) {
+    unchanged = (retained_camera(camera) == _retained_cameras[camera]);
+  }
+  bool light_passes = false;
+  for (uint32_t slot = 0; unchanged && (slot < _retained_cam_materials.size()); ++slot) {
+    const RetainedMaterial& material = _retained_materials[slot];
+    unchanged = retainedMaterialMatches(_retained_cam_materials[slot], material);
+    light_passes |= !material.light_pass_input_name.empty() && !material.binned_lights;
+  }
+  if (unchanged && (!light_passes || (_lights == _retained_lights))) {
+    patchRetained();
+    return;
+  }
+
+  _retained_patches.clear();
+  _retained_dirty = false;
+  _retained_lods_dirty = false;
+  _draw_queue.clearRetained();
+
+  _retained_cam_draw_calls.clear();
+  _retained_cam_order.clear();
+  _retained_cam_materials.clear();
+  _retained_cam_input_overrides.clear();
+  for (auto& [_, retained] : _retained_cam_calls) {
+    const CameraSubmission& call = retained.call;
+    _retained_cam_draw_calls.emplace_back(
+        call.mask, _retained_cam_materials.get(call.material),
+        _retained_cam_input_overrides.get(call.input_overrides), call.mesh, call.model,
+        call.entity);
+    _retained_cam_order.push_back(&retained);
+    retained.packets.clear();
+  }
+  queueCameraDrawCalls(dispatcher, _retained_cam_draw_calls, _retained_cam_materials,
+                       _retained_cam_input_overrides, _retained_cam_order);
+
+  for (auto& [_, retained] : _retained_draw_calls) {
+    const DrawSubmission& call = retained.call;
+    retained.packet = _draw_queue.pushRetained(call.stage, call.framebuffer, call.options,
+                                               call.shader, call.inputs, call.mesh, call.cpid);
+  }
+
+  _retained_cameras.clear();
+  for (uint32_t camera = 0; camera < _cameras.size(); ++camera) {
+    _retained_cameras.push_back(retained_camera(camera));
+  }
+  _retained_view_projections = _camera_view_projections;
+  _retained_lod_scales = _camera_lod_scales;
+  _retained_materials.clear();
+  for (uint32_t slot = 0; slot < _retained_cam_materials.size(); ++slot) {
+    _retained_materials.push_back(retainedMaterial(_retained_cam_materials[slot]));
+  }
+  _retained_lights = _lights;
+}
+
+void Renderer::queueSprites() {
+  const Ptr<Shader> shader = getSpriteShader();
+  const auto material_it = _materials.find(GUID::null);
+  if (_sprite_calls.empty() || (nullptr == shader) || (material_it == _materials.end())) {
+    return;
+  }
+
+  const Material& material = material_it->second;
+  const int stage = material.getStage();
+  DrawOptions options;
+  options.depth_test = material.getDepthTest();
+
+  // textures sharing an atlas bind identically, so their sprites share an input block and batch
+  // together, told apart only by their uv rects
+  for (uint32_t slot = 0; slot < _sprite_textures.size(); ++slot) {
+    const TextureRef& texture_ref = _sprite_textures[slot];
+
+    Vec4f transform;
+    const Texture& texture = resolveTexture(texture_ref, transform);
+    const auto [it, inserted] = _sprite_atlas_inputs.try_emplace(texture.bindingGuid());
+    if (inserted) {
+      it->second = ShaderInputBlock::intern({ShaderInput("tex", texture_ref)});
+    }
+
+    _sprite_texture_inputs.push_back(it->second);
+    _sprite_uv_rects.push_back({packUnorm16(transform.x()), packUnorm16(transform.y()),
+                                packUnorm16(transform.z()), packUnorm16(transform.w())});
+  }
+
+  for (uint32_t camera = 0; camera < _cameras.size(); ++camera) {
+    const CameraInfo& cam_info = _cameras[camera];
+    if (!_framebuffers.contains(cam_info.fb)) {
+      continue;
+    }
+
+    for (const SpriteCall& call : _sprite_calls) {
+      if ((cam_info.mask & call.mask) != CameraMask::empty()) {
+        SpriteInstanceData sprite = call.sprite;
+        std::copy(_sprite_uv_rects[call.texture].begin(), _sprite_uv_rects[call.texture].end(),
+                  sprite.uv_rect);
+        _draw_queue.pushSprite(stage, cam_info.fb, options, shader->guid(),
+                               _sprite_texture_inputs[call.texture], sprite, camera, GUID::null);
+      }
+    }
+  }
+}
+
+void Renderer::preRender(Session& session, Resources& resources) {
+  _time = session.time();
+  mergeSubmissionBuffers();
+
+  _camera_uniforms.assign(_cameras.size(), CameraUniforms());
+
+  _camera_view_projections.assign(_cameras.size(), Mat4f::identity());
+  _camera_lod_scales.assign(_cameras.size(), 0.f);
+  for (uint32_t camera = 0; camera < _cameras.size(); ++camera) {
+    const CameraInfo& cam_info = _cameras[camera];
+    if (const auto it = _framebuffers.find(cam_info.fb); it != _framebuffers.end()) {
+      const Mat4f projection = cam_info.projection(*(it->second));
+      _camera_view_projections[camera] = projection * cam_info.view;
+      _camera_lod_scales[camera] = projection[0][0] * it->second->getSize().x() * 0.5f;
+
+      CameraUniforms& cam_uniforms = _camera_uniforms[camera];
+      cam_uniforms.projection_transform = projection;
+      cam_uniforms.view_transform = cam_info.view;
+      cam_uniforms.view_position =
+          Vec4f(cam_info.position.x(), cam_info.position.y(), cam_info.position.z(), 1.f);
+    }
+  }
+
+  // retained packets have to be queued ahead of everything else in the frame
+  queueRetained(session.dispatcher());
+  queueCameraDrawCalls(session.dispatcher(), _cam_draw_calls, _cam_materials, _cam_input_overrides,
+                       {});
+  for (const DrawSubmission& call : _draw_calls) {
+    _draw_queue.push(call.stage, call.framebuffer, call.options, call.shader, call.inputs,
+                     call.mesh, call.cpid);
+  }
+  _draw_calls.clear();
+
+  const ShaderInputsSlotTable& queued_inputs = _draw_queue.inputs();
+  for (uint32_t slot = 0; slot < queued_inputs.size(); ++slot) {
+    for (const ShaderInput& input : queued_inputs[slot]->inputs()) {
+      input.submitted(*this);
+    }
+  }
+
+  const SlotTable<GUID>& queued_meshes = _draw_queue.meshes();
+  for (uint32_t slot = 0; slot < queued_meshes.size(); ++slot) {
+    _mesh_update_queue.emplace(queued_meshes[slot]);
+  }
+
+  const SlotTable<GUID>& queued_shaders = _draw_queue.shaders();
+  for (uint32_t slot = 0; slot < queued_shaders.size(); ++slot) {
+    _shader_update_queue.emplace(queued_shaders[slot]);
+  }
+
+  for (uint32_t slot = 0; slot < _sprite_textures.size(); ++slot) {
+    queueTextureUpdate(_sprite_textures[slot]);
+  }
 
   for (const GUID& guid : _tileset_update_queue) {
     auto it = _tilesets.find(guid);
@@ -309,7 +1208,9 @@ void Renderer::preRender(Session& session, Resources& resources) {
       }
     }
     if (it != _meshes.end()) {
+      const size_t num_lods = it->second->lods().size();
       it->second->checkAndApplyResourceUpdates(resources);
+      _retained_lods_dirty |= (num_lods != it->second->lods().size());
     }
   }
   _mesh_update_queue.clear();
@@ -329,58 +1230,263 @@ void Renderer::preRender(Session& session, Resources& resources) {
   }
   _shader_update_queue.clear();
 
+  // lights are only binned when one of the frame's shaders reads them
+  _light_uniforms.clear();
+  for (uint32_t slot = 0; slot < queued_shaders.size(); ++slot) {
+    if (const auto it = _shaders.find(queued_shaders[slot]);
+        (it != _shaders.end()) &&
+        (nullptr != it->second->getUniformBlockLayout(UniformBlock::Lights))) {
+      _light_uniforms.assign(_cameras.size(), LightUniforms());
+      break;
+    }
+  }
+  for (uint32_t camera = 0; camera < _light_uniforms.size(); ++camera) {
+    if (const auto it = _framebuffers.find(_cameras[camera].fb); it != _framebuffers.end()) {
+      binLights(_lights, _camera_view_projections[camera], it->second->getSize(),
+                _light_uniforms[camera]);
+    }
+  }
+
   for (auto& [guid, material] : _materials) {
     material.checkAndApplyResourceUpdates(resources);
   }
 
   FramebufferInfo render_info;
   render_info.render_targets[0].clear_colour = Vec4f::ones();
-  render_info.size = _render_size;
+  render_info.size = scaledRenderSize();
   render_info.num_targets = 1;
   submitFramebuffer(GUID::null, render_info);
 
-  std::erase_if(_framebuffers, [](const auto& pair) {
-    return (GUID::null != pair.first) && (!pair.second->getActiveFlag());
-  });
-  for (const auto& [guid, framebuffer] : _framebuffers) {
-    framebuffer->preRender();
+  // framebuffers that weren't submitted this frame are pooled for whichever target needs one next
+  for (auto it = _framebuffers.begin(); it != _framebuffers.end();) {
+    if (!_framebuffer_infos.contains(it->first)) {
+      releaseFramebuffer(std::move(it->second));
+      it = _framebuffers.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void Renderer::cullInstances() {
+  const Profiler::Scope scope("occlusion culling");
+  _culled = false;
+
+  _occlusion_buffers.resize(_cameras.size());
+  std::vector<bool> culling(_cameras.size(), false);
+  for (uint32_t camera = 0; camera < _cameras.size(); ++camera) {
+    const CameraInfo& cam_info = _cameras[camera];
+    if (const auto it = _framebuffers.find(cam_info.fb);
+        cam_info.occlusion_culling && (it != _framebuffers.end())) {
+      _occlusion_buffers[camera].clear(it->second->getSize());
+      culling[camera] = true;
+      _culled = true;
+    }
+  }
+  if (!_culled) {
+    return;
+  }
+
+  const auto cullable = [&](const DrawQueue::Batch& batch) -> const Mesh* {
+    if (batch.sprites || (DrawQueue::NO_CAMERA == batch.camera) || !culling[batch.camera]) {
+      return nullptr;
+    }
+    const auto it = _meshes.find(_draw_queue.meshes()[batch.mesh]);
+    return (it != _meshes.end()) ? it->second.get() : nullptr;
+  };
+
+  // only depth tested draws that fill every pixel they cover can hide what is behind them
+  const auto occludes = [&](const DrawQueue::Batch& batch) {
+    if (!batch.options.depth_test || (DrawQueue::NO_MATERIAL == batch.material)) {
+      return false;
+    }
+    const auto material_it = _materials.find(_draw_queue.materials()[batch.material]);
+    const auto shader_it = _shaders.find(_draw_queue.shaders()[batch.shader]);
+    return (material_it != _materials.end()) && material_it->second.getOpaque() &&
+           (shader_it != _shaders.end()) && !shader_it->second->discards();
+  };
+
+  // the largest occluders on screen go first, until each camera's budget runs out
+  _occluder_candidates.clear();
+  for (const DrawQueue::Batch& batch : _draw_queue.batches()) {
+    const Mesh* mesh = cullable(batch);
+    if ((nullptr == mesh) || mesh->occluderIndices().empty() || !occludes(batch)) {
+      continue;
+    }
+    const OcclusionBuffer& buffer = _occlusion_buffers[batch.camera];
+    for (const CommonPerInstanceData& cpid : _draw_queue.instances(batch)) {
+      if (const float coverage =
+              buffer.coverage(mesh->boundsMin(), mesh->boundsMax(), cpid.mvp_transform);
+          MIN_OCCLUDER_COVERAGE <= coverage) {
+        _occluder_candidates.emplace_back(coverage, batch.camera, mesh, &cpid);
+      }
+    }
+  }
+  std::sort(_occluder_candidates.begin(), _occluder_candidates.end(),
+            [](const OccluderCandidate& a, const OccluderCandidate& b) {
+              return a.coverage > b.coverage;
+            });
+
+  std::vector<size_t> occluder_triangles(_cameras.size(), 0);
+  for (const OccluderCandidate& candidate : _occluder_candidates) {
+    const size_t num_triangles = candidate.mesh->occluderIndices().size() / 3;
+    if (MAX_CAMERA_OCCLUDER_TRIANGLES < (occluder_triangles[candidate.camera] + num_triangles)) {
+      continue;
+    }
+    occluder_triangles[candidate.camera] += num_triangles;
+    _occlusion_buffers[candidate.camera].rasterise(candidate.mesh->occluderPositions(),
+                                                   candidate.mesh->occluderIndices(),
+                                                   candidate.cpid->mvp_transform);
+  }
+  for (uint32_t camera = 0; camera < _cameras.size(); ++camera) {
+    if (culling[camera]) {
+      _occlusion_buffers[camera].finish();
+    }
+  }
+
+  _culled_batches = _draw_queue.batches();
+  _culled_instances.clear();
+  _culled_instances.reserve(_draw_queue.instances().size());
+  for (DrawQueue::Batch& batch : _culled_batches) {
+    if (batch.sprites) {
+      continue;
+    }
+    const std::span<const CommonPerInstanceData> instances = _draw_queue.instances(batch);
+    const uint32_t first_instance = static_cast<uint32_t>(_culled_instances.size());
+    if (const Mesh* mesh = cullable(batch); nullptr != mesh) {
+      const OcclusionBuffer& buffer = _occlusion_buffers[batch.camera];
+      for (const CommonPerInstanceData& cpid : instances) {
+        if (buffer.visible(mesh->boundsMin(), mesh->boundsMax(), cpid.mvp_transform)) {
+          _culled_instances.push_back(cpid);
+        }
+      }
+    } else {
+      _culled_instances.insert(_culled_instances.end(), instances.begin(), instances.end());
+    }
+    batch.first_instance = first_instance;
+    batch.num_instances = static_cast<uint32_t>(_culled_instances.size()) - first_instance;
   }
 }
 
 void Renderer::render() {
-  for (const auto& [stage, fb_options_shader_inputs_mesh_cpids] : _draw_calls) {
-    for (const auto& [fb_guid, options_shader_inputs_mesh_cpids] :
-         fb_options_shader_inputs_mesh_cpids) {
-      if (const auto it = _framebuffers.find(fb_guid); it != _framebuffers.end()) {
-        it->second->bind();
-      } else {
-        continue;
+  queueSprites();
+  _draw_queue.sort();
+  cullInstances();
+  uploadInstances(_culled ? std::span<const CommonPerInstanceData>(_culled_instances)
+                          : _draw_queue.instances());
+  uploadSpriteInstances(_draw_queue.spriteInstances());
+
+  const FrameUniforms frame_uniforms{_time};
+  _frame_uniform_buffer->update(std::as_bytes(std::span(&frame_uniforms, 1)));
+  _frame_uniform_buffer->bind(UniformBlock::Frame, 0, sizeof(FrameUniforms));
+  packUniforms<CameraUniforms>(_camera_uniforms, _camera_uniform_stride, _camera_uniform_data);
+  _camera_uniform_buffer->update(_camera_uniform_data);
+  if (!_light_uniforms.empty()) {
+    packUniforms<LightUniforms>(_light_uniforms, _light_uniform_stride, _light_uniform_data);
+    _light_uniform_buffer->update(_light_uniform_data);
+  }
+
+  planFramebuffers();
+
+  Framebuffer* framebuffer = nullptr;
+  Shader* shader = nullptr;
+  Material* material = nullptr;
+  const DrawQueue::Batch* prev_batch = nullptr;
+  for (const DrawQueue::Batch& batch : _culled ? _culled_batches : _draw_queue.batches()) {
+    const bool framebuffer_changed = (nullptr == prev_batch) ||
+                                     (batch.stage != prev_batch->stage) ||
+                                     (batch.framebuffer != prev_batch->framebuffer);
+    const bool options_changed = framebuffer_changed || (batch.options != prev_batch->options);
+    const bool shader_changed = options_changed || (batch.shader != prev_batch->shader);
+    const bool material_changed = shader_changed || (batch.material != prev_batch->material);
+    const bool camera_changed = material_changed || (batch.camera != prev_batch->camera);
+    const bool inputs_changed = material_changed || (batch.inputs != prev_batch->inputs);
+    prev_batch = &batch;
+
+    if (framebuffer_changed) {
+      framebuffer = nullptr;
+      const GUID& target = _draw_queue.framebuffers()[batch.framebuffer];
+      const auto it = _framebuffers.find(target);
+      if (FramebufferPass& pass = _framebuffer_passes[target];
+          pass.live && (it != _framebuffers.end())) {
+        framebuffer = it->second.get();
+        beginGPUTimer("stage " + std::to_string(batch.stage) + " : " +
+                      ((GUID::null == target) ? std::string("main") : target.hex()));
+        if (pass.begun) {
+          framebuffer->bind();
+        } else {
+          framebuffer->begin();
+          pass.begun = true;
+        }
       }
+    }
+    if (nullptr == framebuffer) {
+      continue;
+    }
+
+    if (options_changed) {
+      useDrawOptions(batch.options);
+    }
 
-      for (const auto& [options, shader_inputs_mesh_cpids] : options_shader_inputs_mesh_cpids) {
-        useDrawOptions(options);
-        for (const auto& [shader_id, inputs_mesh_cpids] : shader_inputs_mesh_cpids) {
-          if (const auto shader_it = _shaders.find(shader_id); shader_it != _shaders.end()) {
-            shader_it->second->use();
-            for (const auto& [inputs, mesh_cpids] : inputs_mesh_cpids) {
-              for (const ShaderInput& input : inputs) {
-                input.bind(*(shader_it->second), *this);
-              }
-              for (const auto& [mesh_id, cpids] : mesh_cpids) {
-                if (const auto mesh_it = _meshes.find(mesh_id); mesh_it != _meshes.end()) {
-                  drawMeshInstances(*(mesh_it->second), cpids);
-                }
-              }
-            }
-          }
+    if (shader_changed) {
+      shader = nullptr;
+      const auto it = _shaders.find(_draw_queue.shaders()[batch.shader]);
+      if (it != _shaders.end()) {
+        shader = it->second.get();
+        shader->use();
+      }
+    }
+    if (nullptr == shader) {
+      continue;
+    }
+
+    if (material_changed) {
+      material = nullptr;
+      if (DrawQueue::NO_MATERIAL != batch.material) {
+        const auto it = _materials.find(_draw_queue.materials()[batch.material]);
+        if (it != _materials.end()) {
+          material = &it->second;
+          bindMaterialUniforms(*shader, *material);
         }
       }
     }
+
+    if (camera_changed && (DrawQueue::NO_CAMERA != batch.camera)) {
+      bindCameraUniforms(*shader, batch.camera, material);
+    }
+
+    if (inputs_changed) {
+      if ((nullptr != material) &&
+          (nullptr == shader->getUniformBlockLayout(UniformBlock::Material))) {
+        for (const ShaderInput& input : material->getUniformInputs()) {
+          input.bind(*shader, *this);
+        }
+      }
+      for (const ShaderInput& input : _draw_queue.inputs()[batch.inputs]->inputs()) {
+        input.bind(*shader, *this);
+      }
+    }
+
+    if (batch.sprites) {
+      drawSpriteInstances(_draw_queue.spriteInstances(batch));
+    } else if (const auto it = _meshes.find(_draw_queue.meshes()[batch.mesh]);
+               it != _meshes.end()) {
+      drawMeshInstances(*(it->second), batch.lod,
+                        _culled ? std::span<const CommonPerInstanceData>(_culled_instances)
+                                      .subspan(batch.first_instance, batch.num_instances)
+                                : _draw_queue.instances(batch));
+    }
   }
 
+  beginGPUTimer("present");
   Framebuffer& main_framebuffer = *_framebuffers.at(GUID::null);
   if (!_blitting_framebuffers.empty()) {
-    main_framebuffer.bind();
+    if (FramebufferPass& main_pass = _framebuffer_passes[GUID::null]; main_pass.begun) {
+      main_framebuffer.bind();
+    } else {
+      main_framebuffer.begin();
+      main_pass.begun = true;
+    }
 
     Ptr<Shader> default_shader = getDefaultShader();
     default_shader->use();
@@ -393,17 +1499,72 @@ void Renderer::render() {
     for (const auto& [priority, guid] : _blitting_framebuffers) {
       ShaderInput("colour", Vec4f::ones()).bind(*default_shader, *this);
       ShaderInput("tex", TextureRef(guid, -1)).bind(*default_shader, *this);
-      drawMeshInstances(*unit_square, cpid);
+      drawMeshInstances(*unit_square, 0, cpid);
     }
   }
 
   copyToScreen(main_framebuffer);
+  endGPUTimer();
+
+  // picked after the frame so all of the next one's framebuffers agree on the scale
+  if (_dynamic_resolution) {
+    _render_scale = _dynamic_resolution->update(
+        Profiler::get().average(Profiler::GPU_FRAME, Profiler::Source::GPU));
+  }
 
   _lights.clear();
   _cameras.clear();
   _cam_draw_calls.clear();
-  _draw_calls.clear();
+  _cam_materials.clear();
+  _cam_input_overrides.clear();
+  _sprite_calls.clear();
+  _sprite_textures.clear();
+  _sprite_texture_inputs.clear();
+  _sprite_uv_rects.clear();
+  _sprite_atlas_inputs.clear();
+  _draw_queue.clear();
+  ShaderInputBlock::collect();
   _blitting_framebuffers.clear();
+  _framebuffer_infos.clear();
+  _framebuffer_passes.clear();
+
+  std::erase_if(_framebuffer_pool, [](PooledFramebuffer& pooled) {
+    return FRAMEBUFFER_POOL_FRAMES < ++pooled.idle_frames;
+  });
+}
+
+void Renderer::bindCameraUniforms(Shader& shader, uint32_t camera, const Material* material) {
+  if (nullptr != shader.getUniformBlockLayout(UniformBlock::Camera)) {
+    _camera_uniform_buffer->bind(UniformBlock::Camera, camera * _camera_uniform_stride,
+                                 sizeof(CameraUniforms));
+  } else {
+    const CameraInfo& cam_info = _cameras[camera];
+    shader.setUniform(projection_transform_uniform, _camera_uniforms[camera].projection_transform);
+    if ((nullptr != material) && material->getViewPositionUniform().has_value()) {
+      shader.setUniform(material->getViewPositionUniform().value(), cam_info.position);
+      shader.setUniform(material->getViewTransformUniform().value(), cam_info.view);
+    }
+  }
+
+  if (nullptr != shader.getUniformBlockLayout(UniformBlock::Lights)) {
+    _light_uniform_buffer->bind(UniformBlock::Lights, camera * _light_uniform_stride,
+                                sizeof(LightUniforms));
+  }
+
+  if (nullptr == shader.getUniformBlockLayout(UniformBlock::Frame)) {
+    shader.setUniform(time_uniform, _time);
+  }
+}
+
+void Renderer::bindMaterialUniforms(Shader& shader, Material& material) {
+  if (const UniformBlockLayout* layout = shader.getUniformBlockLayout(UniformBlock::Material);
+      nullptr != layout) {
+    if (nullptr == material.getUniformBuffer()) {
+      material.setUniformBuffer(createUniformBuffer());
+    }
+    material.updateUniformBuffer(shader);
+    material.getUniformBuffer()->bind(UniformBlock::Material, 0, layout->size);
+  }
 }
 
 void Renderer::drawDebugLine(const Vec2f& a, const Vec2f& b, const CameraMask& mask) {
@@ -432,6 +1593,17 @@ void Renderer::drawDebugRect(const Vec2f& a, const Vec2f& b, const CameraMask& m
   //       getUnitSquare()->guid(), transform.matrix3D() * Mat4f::translation(0.f, 0.f, -0.1f));
 }
 
-Renderer* Renderer::create(Resources& resources) {
-  return new GL3Renderer(resources);
+Renderer* Renderer::create(const SessionConfig& config, Resources& resources) {
+  Renderer* renderer = nullptr;
+  if (const auto* rule = config.getRule<HeadlessRule>(); (nullptr != rule) && rule->value()) {
+    renderer = new NullRenderer();
+  } else {
+    renderer = new GL3Renderer(resources);
+  }
+
+  if (const auto* rule = config.getRule<DynamicResolutionRule>();
+      (nullptr != rule) && (0.0 < rule->frameRate())) {
+    renderer->enableDynamicResolution(1000.0 / rule->frameRate());
+  }
+  return renderer;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "ecs/logic_system.hpp"
 #include "ecs/messages.hpp"
 #include "util/fewi.hpp"
+#include "util/profiler.hpp"
 
 #if defined(PANCAKE_ENABLE_IMGUI)
 #include "imgui/imgui.h"
@@ -25,11 +26,11 @@ using namespace pancake;
 
 Session::Session(SessionConfig&& config)
     : _config(std::move(config)),
-      _event_handler(EventHandler::create()),
-      _input(Input::create()),
+      _event_handler(EventHandler::create(_config)),
+      _input(Input::create(_config)),
       _global_messages(true),
-      _window(Window::create()),
-      _renderer(Renderer::create(_resources)),
+      _window(Window::create(_config)),
+      _renderer(Renderer::create(_config, _resources)),
       _time(0.f) {}
 
 Session::~Session() {
@@ -44,7 +45,24 @@ void Session::addWorld(const Ptr<World>& world) {
 }
 
 void Session::removeWorld(const Ptr<World>& world) {
-  _worlds.erase(world);
+  if (0 == _worlds.erase(world)) {
+    return;
+  }
+
+  // once running, systems release what they retained for the world and stop running on it
+  for (const Ptr<Systems>& systems : {_logic_systems, _draw_systems}) {
+    if (nullptr != systems) {
+      for (const Ptr<System>& system : *systems) {
+        system->removeWorld(*world);
+      }
+    }
+  }
+  if (nullptr != _logic_systems) {
+    _logic_system_graph.build(*_logic_systems, _worlds);
+  }
+  if (nullptr != _draw_systems) {
+    _draw_system_graph.build(*_draw_systems, _worlds);
+  }
 }
 
 const chrono::microseconds target_frame_duration(16670);
@@ -59,8 +77,10 @@ void Session::run() {
   _renderer->setScreenSize(_window->size());
   _renderer->init();
 
-  _logic_system_graph.build(*LogicSystem::createLogicSystems(*this), _worlds);
-  _draw_system_graph.build(*DrawSystem::createDrawSystems(*this), _worlds);
+  _logic_systems = LogicSystem::createLogicSystems(*this);
+  _draw_systems = DrawSystem::createDrawSystems(*this);
+  _logic_system_graph.build(*_logic_systems, _worlds);
+  _draw_system_graph.build(*_draw_systems, _worlds);
   for (const SystemGraph::Node& node : _logic_system_graph.nodes()) {
     node.system()->configure();
   }
@@ -81,6 +101,15 @@ void Session::run() {
     }
   }
 
+  const auto* headless_rule = _config.getRule<HeadlessRule>();
+  const bool headless = (nullptr != headless_rule) && headless_rule->value();
+
+#if defined(PANCAKE_ENABLE_IMGUI)
+  const auto* show_profiler_rule = _config.getRule<ShowProfilerRule>();
+  const bool show_profiler = (nullptr != show_profiler_rule) && show_profiler_rule->value();
+#endif
+  Profiler& profiler = Profiler::get();
+
   chrono::time_point prev_timestamp = chrono::high_resolution_clock::now();
   chrono::nanoseconds accumulator_dur(0);
 
@@ -89,31 +118,58 @@ void Session::run() {
     chrono::time_point timestamp = chrono::high_resolution_clock::now();
     chrono::nanoseconds frame_dur(timestamp - prev_timestamp);
 
-    if (target_frame_duration > frame_dur) {
+    if (headless) {
+      // nothing to present, so run uncapped with exactly one fixed step per frame
+      frame_dur = target_frame_duration;
+    } else if (target_frame_duration > frame_dur) {
       std::this_thread::sleep_for(target_frame_duration - frame_dur);
       timestamp = chrono::high_resolution_clock::now();
       frame_dur = timestamp - prev_timestamp;
     }
     prev_timestamp = timestamp;
 
-    accumulator_dur += frame_dur;
-    while (accumulator_dur >= target_frame_duration) {
+    {
+      // excludes the frame cap's sleep and presenting, which only wait on the gpu or the display
+      const Profiler::Scope frame_scope(Profiler::CPU_FRAME);
+
+      accumulator_dur += frame_dur;
+      while (accumulator_dur >= target_frame_duration) {
 #if defined(PANCAKE_ENABLE_IMGUI)
-      _window->newImGuiFrame();
+        _window->newImGuiFrame();
 #endif
-      _input->refresh();
-      quitting =
-          _event_handler->handleEvents(*this) || (FEWI::Severity::Fatal == fewi.max_severity());
-      _dispatcher.execute(_logic_system_graph);
-
-      accumulator_dur -= target_frame_duration;
-      _time += target_delta;
+        _input->refresh();
+        quitting =
+            _event_handler->handleEvents(*this) || (FEWI::Severity::Fatal == fewi.max_severity());
+        {
+          const Profiler::Scope scope("logic systems");
+          _dispatcher.execute(_logic_system_graph);
+        }
+
+        accumulator_dur -= target_frame_duration;
+        _time += target_delta;
+      }
+
+      {
+        const Profiler::Scope scope("draw systems");
+        _dispatcher.execute(_draw_system_graph);
+      }
+      {
+        const Profiler::Scope scope("pre render");
+        _renderer->preRender(*this, _resources);
+      }
+      {
+        const Profiler::Scope scope("render");
+        _renderer->render();
+      }
     }
 
-    _dispatcher.execute(_draw_system_graph);
-    _renderer->preRender(*this, _resources);
-    _renderer->render();
+#if defined(PANCAKE_ENABLE_IMGUI)
+    if (show_profiler) {
+      profiler.showWindow();
+    }
+#endif
     _window->flip();
+    profiler.endFrame();
   }
 }
 
@@ -145,6 +201,10 @@ Resources& Session::resources() {
   return _resources;
 }
 
+Dispatcher& Session::dispatcher() {
+  return _dispatcher;
+}
+
 float Session::delta() const {
   return target_delta;
 }
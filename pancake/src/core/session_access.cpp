@@ -2,7 +2,8 @@
 
 using namespace pancake;
 
-SessionAccess::SessionAccess() : _imGui(false), _renderer(false), _resources(false) {}
+SessionAccess::SessionAccess()
+    : _imGui(false), _renderer(false), _renderer_submit(false), _resources(false) {}
 
 SessionAccess& SessionAccess::addImGui() {
   _imGui = true;
@@ -14,14 +15,20 @@ SessionAccess& SessionAccess::addRenderer() {
   return *this;
 }
 
+SessionAccess& SessionAccess::addRendererSubmit() {
+  _renderer_submit = true;
+  return *this;
+}
+
 SessionAccess& SessionAccess::addResources() {
   _resources = true;
   return *this;
 }
 
 bool SessionAccess::intersects(const SessionAccess& other) const {
-  return (_imGui && other._imGui) || (_renderer && other._renderer) ||
-         (_resources && other._resources);
+  return (_imGui && other._imGui) ||
+         (_renderer && (other._renderer || other._renderer_submit)) ||
+         (_renderer_submit && other._renderer) || (_resources && other._resources);
 }
 
 bool SessionAccess::hasImGuiAccess() const {
@@ -32,14 +39,19 @@ bool SessionAccess::hasRendererAccess() const {
   return _renderer;
 }
 
+bool SessionAccess::hasRendererSubmitAccess() const {
+  return _renderer_submit;
+}
+
 bool SessionAccess::hasResourcesAccess() const {
   return _resources;
 }
 
 SessionAccess SessionAccess::operator&(const SessionAccess& rhs) const {
   SessionAccess access;
-  access._renderer = _imGui && rhs._imGui;
+  access._imGui = _imGui && rhs._imGui;
   access._renderer = _renderer && rhs._renderer;
+  access._renderer_submit = _renderer_submit && rhs._renderer_submit;
   access._resources = _resources && rhs._resources;
   return access;
 }
@@ -48,6 +60,7 @@ SessionAccess SessionAccess::operator|(const SessionAccess& rhs) const {
   SessionAccess access;
   access._imGui = _imGui || rhs._imGui;
   access._renderer = _renderer || rhs._renderer;
+  access._renderer_submit = _renderer_submit || rhs._renderer_submit;
   access._resources = _resources || rhs._resources;
   return access;
 }
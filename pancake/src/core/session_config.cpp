@@ -2,6 +2,7 @@
 
 #include "util/fewi.hpp"
 
+#include <charconv>
 #include <map>
 
 using namespace pancake;
@@ -93,5 +94,67 @@ const std::vector<std::string>& ResourcePathsRule::resourcePaths() const {
   return _resource_paths;
 }
 
+void HeadlessRule::operator()(CmdLineOptions& options, std::string_view option) {
+  _value = true;
+
+  if ("--headless-frames" == option) {
+    const std::string_view frames = options.consume();
+    if (const auto result = std::from_chars(frames.data(), frames.data() + frames.size(), _frames);
+        (std::errc() != result.ec) || (frames.data() + frames.size() != result.ptr)) {
+      FEWI::warn() << "Invalid value found for " << option << " : " << frames;
+      _frames = 0;
+    }
+  }
+}
+
+const std::set<std::string>& HeadlessRule::getOptions() const {
+  static const std::set<std::string> options{"--headless", "--headless-frames"};
+  return options;
+}
+
+bool HeadlessRule::value() const {
+  return _value;
+}
+
+uint64_t HeadlessRule::frames() const {
+  return _frames;
+}
+
+void DynamicResolutionRule::operator()(CmdLineOptions& options, std::string_view option) {
+  const std::string_view frame_rate = options.consume();
+  if (const auto result =
+          std::from_chars(frame_rate.data(), frame_rate.data() + frame_rate.size(), _frame_rate);
+      (std::errc() != result.ec) || (frame_rate.data() + frame_rate.size() != result.ptr) ||
+      (_frame_rate <= 0.0)) {
+    FEWI::warn() << "Invalid value found for " << option << " : " << frame_rate;
+    _frame_rate = 0.0;
+  }
+}
+
+const std::set<std::string>& DynamicResolutionRule::getOptions() const {
+  static const std::set<std::string> options{"--dynamic-resolution"};
+  return options;
+}
+
+double DynamicResolutionRule::frameRate() const {
+  return _frame_rate;
+}
+
+void ShowProfilerRule::operator()(CmdLineOptions& options, std::string_view option) {
+  _value = true;
+}
+
+const std::set<std::string>& ShowProfilerRule::getOptions() const {
+  static const std::set<std::string> options{"--show-profiler"};
+  return options;
+}
+
+bool ShowProfilerRule::value() const {
+  return _value;
+}
+
 SessionConfigRule::StaticAdder<LogSystemGraphsRule> _log_system_graphs_rule_adder;
-SessionConfigRule::StaticAdder<ResourcePathsRule> _resource_paths_rule_adder;
\ No newline at end of file
+SessionConfigRule::StaticAdder<ResourcePathsRule> _resource_paths_rule_adder;
+SessionConfigRule::StaticAdder<HeadlessRule> _headless_rule_adder;
+SessionConfigRule::StaticAdder<DynamicResolutionRule> _dynamic_resolution_rule_adder;
+SessionConfigRule::StaticAdder<ShowProfilerRule> _show_profiler_rule_adder;
\ No newline at end of file
@@ -1,9 +1,14 @@
 #include "core/window.hpp"
 
+#include "core/session_config.hpp"
 #include "gl3/gl3_sdl3_window.hpp"
+#include "null/null_window.hpp"
 
 using namespace pancake;
 
-Window* Window::create() {
+Window* Window::create(const SessionConfig& config) {
+  if (const auto* rule = config.getRule<HeadlessRule>(); (nullptr != rule) && rule->value()) {
+    return new NullWindow(Vec2i(1024, 800));
+  }
   return new GL3SDL3Window();
 }
\ No newline at end of file
@@ -22,6 +22,7 @@ std::span<std::reference_wrapper<const TypeDesc>> pancake::default_components::g
       TypeDescLibrary::get<LineRenderer2D>(),
       TypeDescLibrary::get<Transform3D>(),
       TypeDescLibrary::get<MeshInstance>(),
+      TypeDescLibrary::get<StaticMesh>(),
       TypeDescLibrary::get<MaterialInstance>(),
       TypeDescLibrary::get<PointLight>(),
       TypeDescLibrary::get<Camera3D>(),
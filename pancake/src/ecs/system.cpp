@@ -17,6 +17,10 @@ void System::configure() {
   _configure(_session);
 }
 
+void System::removeWorld(const World& world) {
+  _removeWorld(_session, world);
+}
+
 void System::run(SystemNodeId system_node) const {
   for (MessageId id : getMessageAccess().getSends()) {
     _session.messageBoard(id).clearFrom(system_node);
@@ -33,6 +37,7 @@ void System::run(World& world, SystemNodeId system_node) const {
 }
 
 void System::_configure(Session& session) {}
+void System::_removeWorld(Session& session, const World& world) {}
 
 void System::_run(const SessionWrapper& session) const {}
 void System::_run(const SessionWrapper& session, const WorldWrapper& world) const {}
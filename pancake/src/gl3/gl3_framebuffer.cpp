@@ -1,5 +1,6 @@
 #include "gl3/gl3_framebuffer.hpp"
 
+#include "gl3/gl3_state_cache.hpp"
 #include "util/fewi.hpp"
 
 #include "GL/gl3w.h"
@@ -13,6 +14,7 @@ GL3Framebuffer::GL3Framebuffer(const GUID& guid, const FramebufferInfo& info) :
 GL3Framebuffer::~GL3Framebuffer() {
   glDeleteRenderbuffers(1, &_depth_stencil);
   glDeleteFramebuffers(1, &_fbo);
+  GL3StateCache::get().invalidate();
 }
 
 unsigned int GL3Framebuffer::id() {
@@ -23,7 +25,7 @@ void GL3Framebuffer::update() {
   if (0 == _fbo) {
     glGenFramebuffers(1, &_fbo);
   }
-  glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+  GL3StateCache::get().bindFramebuffer(_fbo);
 
   const GLenum draw_buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2,
                                  GL_COLOR_ATTACHMENT3};
@@ -60,22 +62,19 @@ void GL3Framebuffer::update() {
   glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x(), size.y());
   glBindRenderbuffer(GL_RENDERBUFFER, 0);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GL3StateCache::get().bindFramebuffer(0);
 }
 
 void GL3Framebuffer::bind() {
-  glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, _fbo);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fbo);
+  GL3StateCache& state = GL3StateCache::get();
+  state.bindFramebuffer(_fbo);
 
+  state.setDepthTest(_depth_test);
   if (_depth_test) {
-    glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
-  } else {
-    glDisable(GL_DEPTH_TEST);
   }
 
-  glEnable(GL_BLEND);
+  state.setBlend(true);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
   const Vec2i& size = getSize();
@@ -94,8 +93,8 @@ void GL3Framebuffer::preRender() {
 }
 
 void GL3Framebuffer::blit(const GL3Framebuffer& src) {
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, src._fbo);
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _fbo);
+  GL3StateCache::get().bindReadFramebuffer(src._fbo);
+  GL3StateCache::get().bindDrawFramebuffer(_fbo);
 
   const Vec2i& src_size = src.getSize();
   const Vec2i& size = getSize();
@@ -111,7 +110,7 @@ OptTextureConstRef GL3Framebuffer::texture(size_t i) const {
 }
 
 void GL3Framebuffer::readPixel(size_t attachment, const Vec2u& position, Vec4u& pixel) const {
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, _fbo);
+  GL3StateCache::get().bindReadFramebuffer(_fbo);
   glReadBuffer(GL_COLOR_ATTACHMENT0 + attachment);
   glReadPixels(position.x(), getSize().y() - position.y(), 1, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT,
                &pixel.m[0][0]);
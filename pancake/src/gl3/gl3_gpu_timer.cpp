@@ -0,0 +1,100 @@
+#include "gl3/gl3_gpu_timer.hpp"
+
+#include "util/fewi.hpp"
+#include "util/profiler.hpp"
+
+#include "GL/gl3w.h"
+
+#include <cstdint>
+
+using namespace pancake;
+
+GL3GPUTimer::GL3GPUTimer()
+    : _frames(), _frame_index(0), _frame_id(0), _open(false), _dropped_frames(0) {}
+
+GL3GPUTimer::~GL3GPUTimer() {
+  if (_open) {
+    glEndQuery(GL_TIME_ELAPSED);
+  }
+  for (Frame& frame : _frames) {
+    if (!frame.queries.empty()) {
+      glDeleteQueries(static_cast<int>(frame.queries.size()), frame.queries.data());
+    }
+  }
+
+  if (0 < _dropped_frames) {
+    FEWI::info() << "GPU timer : " << _dropped_frames << " frames dropped waiting on results";
+  }
+}
+
+void GL3GPUTimer::begin(std::string name) {
+  end();
+
+  Frame& frame = _frames[_frame_index];
+  if (frame.used == frame.queries.size()) {
+    unsigned int query = 0;
+    glGenQueries(1, &query);
+    frame.queries.push_back(query);
+    frame.names.emplace_back();
+  }
+
+  frame.names[frame.used] = std::move(name);
+  glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used]);
+  ++frame.used;
+  _open = true;
+}
+
+void GL3GPUTimer::end() {
+  if (_open) {
+    glEndQuery(GL_TIME_ELAPSED);
+    _open = false;
+  }
+}
+
+void GL3GPUTimer::endFrame() {
+  end();
+  _frames[_frame_index].pending = (0 < _frames[_frame_index].used);
+  _frames[_frame_index].id = _frame_id++;
+
+  // oldest first, so results are reported in the order they were measured
+  for (size_t i = 1; i <= FRAMES_IN_FLIGHT; ++i) {
+    Frame& frame = _frames[(_frame_index + i) % FRAMES_IN_FLIGHT];
+    if (frame.pending && !collect(frame)) {
+      break;
+    }
+  }
+
+  _frame_index = (_frame_index + 1) % FRAMES_IN_FLIGHT;
+
+  // still unavailable after every other frame in flight, rather than wait its queries are reused
+  Frame& next = _frames[_frame_index];
+  if (next.pending) {
+    ++_dropped_frames;
+  }
+  next.used = 0;
+  next.pending = false;
+}
+
+bool GL3GPUTimer::collect(Frame& frame) {
+  // queries complete in order, so the last one being available means all of them are
+  int available = 0;
+  glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+  if (0 == available) {
+    return false;
+  }
+
+  Profiler& profiler = Profiler::get();
+  double total = 0.0;
+  for (size_t i = 0; i < frame.used; ++i) {
+    uint64_t nanoseconds = 0;
+    glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &nanoseconds);
+
+    const double milliseconds = static_cast<double>(nanoseconds) / 1000000.0;
+    profiler.record(frame.names[i], Profiler::Source::GPU, milliseconds, frame.id);
+    total += milliseconds;
+  }
+  profiler.record(Profiler::GPU_FRAME, Profiler::Source::GPU, total, frame.id);
+
+  frame.pending = false;
+  return true;
+}
\ No newline at end of file
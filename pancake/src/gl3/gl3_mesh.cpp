@@ -1,45 +1,105 @@
 #include "gl3/gl3_mesh.hpp"
 
 #include "gl3/gl3_renderer.hpp"
+#include "gl3/gl3_state_cache.hpp"
+#include "gl3/gl3_upload_queue.hpp"
 
 #include "GL/gl3w.h"
 
 using namespace pancake;
 
-GL3Mesh::GL3Mesh(const GUID& guid, unsigned int instance_vbo)
-    : Mesh(guid), _vao(0), _vbo(0), _ebo(0), _num_indices(0), _instance_vbo(instance_vbo) {}
+static void pointVertexAttributes(const VertexLayout& layout) {
+  const GLsizei stride = static_cast<GLsizei>(layout.stride());
+  for (unsigned int i = 0; i < VertexLayout::NUM_ATTRIBUTES; ++i) {
+    const VertexAttribute& attribute = layout.attributes()[i];
+    const void* offset = reinterpret_cast<void*>(static_cast<size_t>(attribute.offset));
+    switch (attribute.type) {
+      case VertexAttributeType::Float32:
+        glVertexAttribPointer(i, attribute.components, GL_FLOAT, GL_FALSE, stride, offset);
+        break;
+      case VertexAttributeType::Float16:
+        glVertexAttribPointer(i, attribute.components, GL_HALF_FLOAT, GL_FALSE, stride, offset);
+        break;
+      case VertexAttributeType::Snorm2_10_10_10:
+        glVertexAttribPointer(i, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+        break;
+      case VertexAttributeType::Unorm8:
+        glVertexAttribPointer(i, attribute.components, GL_UNSIGNED_BYTE, GL_TRUE, stride, offset);
+        break;
+    }
+  }
+}
+
+static void pointInstanceAttributes(unsigned int first_instance) {
+  const size_t offset = sizeof(CommonPerInstanceData) * first_instance;
+  const unsigned int iis = 6;
+
+  for (unsigned int i = 0; i < 8; ++i) {
+    glVertexAttribPointer(iis + i, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
+                          reinterpret_cast<void*>(offset + (i * sizeof(Vec4f))));
+  }
+  glVertexAttribIPointer(iis + 8, 4, GL_UNSIGNED_INT, sizeof(CommonPerInstanceData),
+                         reinterpret_cast<void*>(offset + (8 * sizeof(Vec4f))));
+}
+
+GL3Mesh::GL3Mesh(const GUID& guid, unsigned int instance_vbo, Ptr<GL3UploadQueue> upload_queue)
+    : Mesh(guid),
+      _vao(0),
+      _vbo(0),
+      _ebo(0),
+      _layout(VertexLayout::full()),
+      _vertex_capacity(0),
+      _index_capacity(0),
+      _num_indices(0),
+      _uploaded_lods(),
+      _index_type(GL_UNSIGNED_INT),
+      _instance_vbo(instance_vbo),
+      _upload_queue(upload_queue),
+      _attrib_first_instance(0) {
+  createBuffers();
+}
 
 GL3Mesh::GL3Mesh(const GUID& guid,
                  std::span<const Vertex> vertices,
                  std::span<const unsigned int> indices,
-                 unsigned int instance_vbo)
-    : Mesh(guid), _vao(0), _vbo(0), _ebo(0), _num_indices(0), _instance_vbo(instance_vbo) {
+                 unsigned int instance_vbo,
+                 Ptr<GL3UploadQueue> upload_queue)
+    : Mesh(guid),
+      _vao(0),
+      _vbo(0),
+      _ebo(0),
+      _layout(VertexLayout::full()),
+      _vertex_capacity(0),
+      _index_capacity(0),
+      _num_indices(0),
+      _uploaded_lods(),
+      _index_type(GL_UNSIGNED_INT),
+      _instance_vbo(instance_vbo),
+      _upload_queue(upload_queue),
+      _attrib_first_instance(0) {
+  createBuffers();
   update(vertices, indices);
 }
 
 GL3Mesh::~GL3Mesh() {
+  _upload_queue->cancel(this);
   glDeleteVertexArrays(1, &_vao);
   glDeleteBuffers(1, &_vbo);
   glDeleteBuffers(1, &_ebo);
+  GL3StateCache::get().invalidate();
 }
 
-void GL3Mesh::update(std::span<const Vertex> vertices, std::span<const unsigned int> indices) {
-  glDeleteVertexArrays(1, &_vao);
-  glDeleteBuffers(1, &_vbo);
-  glDeleteBuffers(1, &_ebo);
-
+void GL3Mesh::createBuffers() {
   glGenVertexArrays(1, &_vao);
   glGenBuffers(1, &_vbo);
   glGenBuffers(1, &_ebo);
 
-  glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+  GL3StateCache& state = GL3StateCache::get();
+  state.bindVertexArray(_vao);
 
+  // the element buffer binding is vao state, so draws only need to bind the vao
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * indices.size(), indices.data(),
-               GL_STATIC_DRAW);
-
-  glBindVertexArray(_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, _vbo);
 
   glEnableVertexAttribArray(0);
   glEnableVertexAttribArray(1);
@@ -48,17 +108,7 @@ void GL3Mesh::update(std::span<const Vertex> vertices, std::span<const unsigned
   glEnableVertexAttribArray(4);
   glEnableVertexAttribArray(5);
 
-  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
-  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        reinterpret_cast<void*>(sizeof(Vec4f)));
-  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        reinterpret_cast<void*>(2 * sizeof(Vec4f)));
-  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        reinterpret_cast<void*>(3 * sizeof(Vec4f)));
-  glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        reinterpret_cast<void*>(4 * sizeof(Vec4f)));
-  glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        reinterpret_cast<void*>((4 * sizeof(Vec4f)) + sizeof(Vec2f)));
+  pointVertexAttributes(_layout);
 
   glVertexAttribDivisor(0, 0);
   glVertexAttribDivisor(1, 0);
@@ -81,23 +131,8 @@ void GL3Mesh::update(std::span<const Vertex> vertices, std::span<const unsigned
   glEnableVertexAttribArray(iis + 7);
   glEnableVertexAttribArray(iis + 8);
 
-  glVertexAttribPointer(iis, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData), nullptr);
-  glVertexAttribPointer(iis + 1, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
-                        reinterpret_cast<void*>(sizeof(Vec4f)));
-  glVertexAttribPointer(iis + 2, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
-                        reinterpret_cast<void*>(2 * sizeof(Vec4f)));
-  glVertexAttribPointer(iis + 3, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
-                        reinterpret_cast<void*>(3 * sizeof(Vec4f)));
-  glVertexAttribPointer(iis + 4, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
-                        reinterpret_cast<void*>(4 * sizeof(Vec4f)));
-  glVertexAttribPointer(iis + 5, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
-                        reinterpret_cast<void*>(5 * sizeof(Vec4f)));
-  glVertexAttribPointer(iis + 6, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
-                        reinterpret_cast<void*>(6 * sizeof(Vec4f)));
-  glVertexAttribPointer(iis + 7, 4, GL_FLOAT, GL_FALSE, sizeof(CommonPerInstanceData),
-                        reinterpret_cast<void*>(7 * sizeof(Vec4f)));
-  glVertexAttribIPointer(iis + 8, 4, GL_UNSIGNED_INT, sizeof(CommonPerInstanceData),
-                         reinterpret_cast<void*>(8 * sizeof(Vec4f)));
+  pointInstanceAttributes(0);
+  _attrib_first_instance = 0;
 
   glVertexAttribDivisor(iis, 1);
   glVertexAttribDivisor(iis + 1, 1);
@@ -109,18 +144,114 @@ void GL3Mesh::update(std::span<const Vertex> vertices, std::span<const unsigned
   glVertexAttribDivisor(iis + 7, 1);
   glVertexAttribDivisor(iis + 8, 1);
 
-  glBindVertexArray(0);
+  state.bindVertexArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void GL3Mesh::update(std::span<const Vertex> vertices,
+                     std::span<const unsigned int> indices,
+                     const VertexLayout& layout,
+                     std::span<const unsigned int> lod_indices,
+                     std::span<const MeshLod> lods) {
+  // anything still pending is superseded by this data
+  _upload_queue->cancel(this);
+  updateShape(vertices, indices, lods);
+
+  if (layout != _layout) {
+    GL3StateCache::get().bindVertexArray(_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    pointVertexAttributes(layout);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    _layout = layout;
+    _num_indices = 0;
+    _uploaded_lods.clear();
+  }
+
+  std::vector<std::byte> packed_vertices;
+  const std::span<const std::byte> vertex_bytes = layout.pack(vertices, packed_vertices);
+
+  // lods follow full detail in the same element buffer
+  std::vector<unsigned int> all_indices;
+  if (!lod_indices.empty()) {
+    all_indices.reserve(indices.size() + lod_indices.size());
+    all_indices.assign(indices.begin(), indices.end());
+    all_indices.insert(all_indices.end(), lod_indices.begin(), lod_indices.end());
+    indices = all_indices;
+  }
 
-  _num_indices = static_cast<unsigned int>(indices.size());
+  // 16 bit indices whenever every vertex is addressable, halving index bandwidth
+  std::vector<uint16_t> short_indices;
+  std::span<const std::byte> index_bytes = std::as_bytes(indices);
+  const unsigned int index_type =
+      (vertices.size() <= 0x10000) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  if (GL_UNSIGNED_SHORT == index_type) {
+    short_indices.assign(indices.begin(), indices.end());
+    index_bytes = std::as_bytes(std::span<const uint16_t>(short_indices));
+  }
+
+  // buffers are only reallocated when the data outgrows them, otherwise they are reused in place
+  if (_vertex_capacity < vertex_bytes.size()) {
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertex_bytes.size(), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    _vertex_capacity = vertex_bytes.size();
+    _num_indices = 0;
+    _uploaded_lods.clear();
+  }
+  if (_index_capacity < index_bytes.size()) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _ebo);
+    glBufferData(GL_COPY_WRITE_BUFFER, index_bytes.size(), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    _index_capacity = index_bytes.size();
+    _num_indices = 0;
+    _uploaded_lods.clear();
+  }
+
+  const unsigned int num_indices = static_cast<unsigned int>(indices.size() - lod_indices.size());
+  std::vector<MeshLod> uploaded_lods(lods.begin(), lods.end());
+  for (MeshLod& lod : uploaded_lods) {
+    lod.first_index += num_indices;
+  }
+
+  // if the budget splits the two uploads across frames, nothing is drawn in between
+  _upload_queue->queueBuffer(this, _vbo, 0, vertex_bytes, [this]() {
+    _num_indices = 0;
+    _uploaded_lods.clear();
+  });
+  _upload_queue->queueBuffer(
+      this, _ebo, 0, index_bytes,
+      [this, num_indices, index_type, uploaded_lods = std::move(uploaded_lods)]() {
+        _num_indices = num_indices;
+        _index_type = index_type;
+        _uploaded_lods = uploaded_lods;
+      });
 }
 
-void GL3Mesh::draw(unsigned int num_instances) const {
-  glBindVertexArray(_vao);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
-  glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(_num_indices), GL_UNSIGNED_INT,
-                          nullptr, num_instances);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+void GL3Mesh::draw(unsigned int num_instances, unsigned int first_instance, uint32_t lod) const {
+  static const bool base_instance_supported = (0 != gl3wIsSupported(4, 2));
+
+  unsigned int first_index = 0;
+  unsigned int num_indices = _num_indices;
+  if ((0 < lod) && (lod <= _uploaded_lods.size())) {
+    first_index = _uploaded_lods[lod - 1].first_index;
+    num_indices = _uploaded_lods[lod - 1].num_indices;
+  }
+  const size_t index_size =
+      (GL_UNSIGNED_SHORT == _index_type) ? sizeof(uint16_t) : sizeof(uint32_t);
+  const void* offset = reinterpret_cast<void*>(first_index * index_size);
+
+  GL3StateCache::get().bindVertexArray(_vao);
+  if (base_instance_supported) {
+    glDrawElementsInstancedBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(num_indices),
+                                        _index_type, offset, num_instances, first_instance);
+  } else {
+    if (_attrib_first_instance != first_instance) {
+      glBindBuffer(GL_ARRAY_BUFFER, _instance_vbo);
+      pointInstanceAttributes(first_instance);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      _attrib_first_instance = first_instance;
+    }
+    glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(num_indices), _index_type, offset,
+                            num_instances);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "gl3/gl3_program_cache.hpp"
+
+#include "util/fewi.hpp"
+
+#include "GL/gl3w.h"
+#include "SDL3/SDL.h"
+
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+using namespace pancake;
+
+namespace fs = std::filesystem;
+
+static const uint32_t MAGIC = 0x42504B50;  // "PKPB"
+static const uint32_t VERSION = 1;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint32_t format;
+  uint32_t size;
+};
+
+// fnv-1a, stable across runs and builds unlike std::hash
+static uint64_t hash(uint64_t hash, std::string_view data) {
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001B3ull;
+  }
+  // separates consecutive strings, so moving text between them changes the hash
+  hash ^= 0xFF;
+  return hash * 0x100000001B3ull;
+}
+
+static std::string_view glString(GLenum name) {
+  const GLubyte* string = glGetString(name);
+  return (nullptr != string) ? reinterpret_cast<const char*>(string) : "";
+}
+
+static bool hasExtension(std::string_view extension) {
+  GLint num_extensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+  for (GLint i = 0; i < num_extensions; ++i) {
+    const GLubyte* name = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+    if ((nullptr != name) && (extension == reinterpret_cast<const char*>(name))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+GL3ProgramCache& GL3ProgramCache::get() {
+  static GL3ProgramCache cache;
+  return cache;
+}
+
+GL3ProgramCache::GL3ProgramCache() : _enabled(false), _driver(), _directory() {
+  // core since 4.1, but 3.3 contexts commonly expose it as an extension
+  GLint num_formats = 0;
+  if ((0 != gl3wIsSupported(4, 1)) || hasExtension("GL_ARB_get_program_binary")) {
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+  }
+  if (0 == num_formats) {
+    FEWI::info() << "Program binaries unsupported, shaders won't be cached";
+    return;
+  }
+
+  _driver.append(glString(GL_VENDOR)).append("\n");
+  _driver.append(glString(GL_RENDERER)).append("\n");
+  _driver.append(glString(GL_VERSION)).append("\n");
+  _driver.append(glString(GL_SHADING_LANGUAGE_VERSION));
+
+  if (char* pref_path = SDL_GetPrefPath("pancake", "pancake"); nullptr != pref_path) {
+    _directory = fs::path(pref_path) / "program_cache";
+    SDL_free(pref_path);
+  } else {
+    std::error_code error;
+    _directory = fs::temp_directory_path(error) / "pancake_program_cache";
+  }
+
+  std::error_code error;
+  fs::create_directories(_directory, error);
+  if (error) {
+    FEWI::warn() << "Failed to create program cache " << _directory.string() << " : "
+                 << error.message();
+    return;
+  }
+  _enabled = true;
+}
+
+bool GL3ProgramCache::load(const GUID& shader,
+                           unsigned int program,
+                           std::string_view vert_source,
+                           std::string_view frag_source) {
+  if (!_enabled) {
+    return false;
+  }
+
+  std::ifstream file(path(shader), std::ios_base::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+
+  file.seekg(0, std::ios_base::end);
+  const std::streamoff file_size = file.tellg();
+  file.seekg(0, std::ios_base::beg);
+
+  // a truncated or padded file, e.g. from a crash mid write by an older build, is never trusted
+  Header header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(Header)) || (MAGIC != header.magic) ||
+      (VERSION != header.version) || (key(vert_source, frag_source) != header.key) ||
+      (static_cast<std::streamoff>(sizeof(Header) + header.size) != file_size)) {
+    return false;
+  }
+  std::vector<char> binary(header.size);
+  if (!file.read(binary.data(), header.size)) {
+    return false;
+  }
+
+  // drivers may still reject a binary they wrote, after an update that kept their version string
+  glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(header.size));
+  GLint success = 0;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  return 0 != success;
+}
+
+void GL3ProgramCache::prepare(unsigned int program) const {
+  if (_enabled) {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+}
+
+void GL3ProgramCache::store(const GUID& shader,
+                            unsigned int program,
+                            std::string_view vert_source,
+                            std::string_view frag_source) {
+  if (!_enabled) {
+    return;
+  }
+
+  GLint size = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+  if (size <= 0) {
+    return;
+  }
+
+  Header header{MAGIC, VERSION, key(vert_source, frag_source), 0, 0};
+  std::vector<char> binary(size);
+  GLsizei length = 0;
+  GLenum format = 0;
+  glGetProgramBinary(program, size, &length, &format, binary.data());
+  header.format = format;
+  header.size = static_cast<uint32_t>(length);
+
+  // written aside and renamed over the old binary, so a reader never sees half a file
+  const fs::path final_path = path(shader);
+  fs::path temp_path = final_path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios_base::binary | std::ios_base::trunc);
+    if (!file.is_open() || !file.write(reinterpret_cast<const char*>(&header), sizeof(Header)) ||
+        !file.write(binary.data(), length)) {
+      FEWI::warn() << "Failed to write program cache " << temp_path.string();
+      return;
+    }
+  }
+
+  std::error_code error;
+  fs::rename(temp_path, final_path, error);
+  if (error) {
+    FEWI::warn() << "Failed to write program cache " << final_path.string() << " : "
+                 << error.message();
+  }
+}
+
+uint64_t GL3ProgramCache::key(std::string_view vert_source, std::string_view frag_source) const {
+  uint64_t key = 0xCBF29CE484222325ull;
+  key = hash(key, _driver);
+  key = hash(key, vert_source);
+  return hash(key, frag_source);
+}
+
+fs::path GL3ProgramCache::path(const GUID& shader) const {
+  return _directory / (shader.hex() + ".bin");
+}
\ No newline at end of file
@@ -1,28 +1,125 @@
 #include "gl3/gl3_renderer.hpp"
 
 #include "gl3/gl3_framebuffer.hpp"
+#include "gl3/gl3_gpu_timer.hpp"
 #include "gl3/gl3_mesh.hpp"
 #include "gl3/gl3_shader.hpp"
+#include "gl3/gl3_state_cache.hpp"
+#include "gl3/gl3_uniform_buffer.hpp"
+#include "gl3/gl3_upload_queue.hpp"
 #include "graphics/atlassed_texture.hpp"
 #include "resources/gl3_shader_resource.hpp"
 #include "resources/image_resource.hpp"
 #include "resources/resources.hpp"
 #include "resources/text_resource.hpp"
+#include "util/fewi.hpp"
 #include "util/matrix.hpp"
 
 #include "GL/gl3w.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <functional>
 
 using namespace pancake;
 
-GL3Renderer::AtlasInfo::AtlasInfo() : props(new TexturePropsResource("", GUID::null)) {}
+// each atlas needs its own guid, textures bind and share slots by their atlas' guid
+GL3Renderer::AtlasInfo::AtlasInfo() : props(new TexturePropsResource("", GUID::gen())) {}
+
+static const size_t INITIAL_INSTANCE_CAPACITY = 4096;
+static const size_t INITIAL_SPRITE_CAPACITY = 16384;
+static const size_t UPLOAD_BUDGET_PER_FRAME = 8 * 1024 * 1024;
+
+// appends count elements to a streaming buffer, orphaning its storage rather than wait on draws
+// still reading it once it runs out of room. returns the index of the first element written
+static unsigned int streamBuffer(unsigned int vbo,
+                                 size_t stride,
+                                 size_t& capacity,
+                                 size_t& offset,
+                                 const void* data,
+                                 size_t count) {
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+  if (capacity < (offset + count)) {
+    while (capacity < count) {
+      capacity *= 2;
+    }
+    glBufferData(GL_ARRAY_BUFFER, stride * capacity, nullptr, GL_STREAM_DRAW);
+    offset = 0;
+  }
+
+  glBufferSubData(GL_ARRAY_BUFFER, stride * offset, stride * count, data);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  const unsigned int first = static_cast<unsigned int>(offset);
+  offset += count;
+  return first;
+}
+
+// index of span's first element within the frame upload, or -1 when it lies outside it
+template <typename T>
+static long long frameIndex(std::span<const T> span, std::span<const T> frame) {
+  const std::less<const T*> less;
+  if (!less(span.data(), frame.data()) &&
+      !less(frame.data() + frame.size(), span.data() + span.size())) {
+    return span.data() - frame.data();
+  }
+  return -1;
+}
+
+static void pointSpriteAttributes(unsigned int first_instance) {
+  const size_t offset = sizeof(SpriteInstanceData) * first_instance;
+  const GLsizei stride = sizeof(SpriteInstanceData);
+
+  glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<void*>(offset + offsetof(SpriteInstanceData, position)));
+  glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, stride,
+                        reinterpret_cast<void*>(offset + offsetof(SpriteInstanceData, rotation)));
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                        reinterpret_cast<void*>(offset + offsetof(SpriteInstanceData, uv_rect)));
+  glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                        reinterpret_cast<void*>(offset + offsetof(SpriteInstanceData, colour)));
+}
 
 GL3Renderer::GL3Renderer(Resources& resources)
-    : _next_texture_slot(0), _texture_slots(16, GUID::null) {
+    : _resources(resources),
+      _upload_queue(std::make_shared<GL3UploadQueue>(UPLOAD_BUDGET_PER_FRAME)),
+      _gpu_timer(std::make_shared<GL3GPUTimer>()),
+      _instance_capacity(INITIAL_INSTANCE_CAPACITY),
+      _instance_offset(0),
+      _frame_instances(),
+      _frame_first_instance(0),
+      _sprite_vao(0),
+      _sprite_vbo(0),
+      _sprite_capacity(INITIAL_SPRITE_CAPACITY),
+      _sprite_offset(0),
+      _frame_sprites(),
+      _frame_first_sprite(0),
+      _sprite_attrib_first_instance(0),
+      _sprite_shader(GUID::null),
+      _texture_slot_clock(0),
+      _texture_slots(16, GUID::null),
+      _texture_slot_last_use(16, 0),
+      _texture_slot_lookup() {
   glGenBuffers(1, &_instance_vbo);
   glBindBuffer(GL_ARRAY_BUFFER, _instance_vbo);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(Mat4f) * 100, nullptr, GL_DYNAMIC_DRAW);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(CommonPerInstanceData) * _instance_capacity, nullptr,
+               GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // sprites have no vertex buffer, the shader expands each instance into a quad from gl_VertexID
+  glGenVertexArrays(1, &_sprite_vao);
+  glGenBuffers(1, &_sprite_vbo);
+  GL3StateCache::get().bindVertexArray(_sprite_vao);
+  glBindBuffer(GL_ARRAY_BUFFER, _sprite_vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(SpriteInstanceData) * _sprite_capacity, nullptr,
+               GL_STREAM_DRAW);
+  for (unsigned int i = 0; i < 4; ++i) {
+    glEnableVertexAttribArray(i);
+    glVertexAttribDivisor(i, 1);
+  }
+  pointSpriteAttributes(0);
+  GL3StateCache::get().bindVertexArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   const Vertex vertices[] = {
@@ -84,22 +181,70 @@ GL3Renderer::GL3Renderer(Resources& resources)
       _shaders.emplace(shader_src.guid(), createShader(shader_src));
     }
   }
+
+  {
+    std::optional<std::reference_wrapper<TextResource>> vert_src =
+        resources.getOrCreate<TextResource>("shaders/lighting_vert.glsl");
+    std::optional<std::reference_wrapper<TextResource>> frag_src =
+        resources.getOrCreate<TextResource>("shaders/lighting_frag.glsl");
+    std::optional<std::reference_wrapper<GL3ShaderResource>> shader_src_opt =
+        resources.getOrCreate<GL3ShaderResource>("shaders/lighting.glsl_shader", false);
+    if (vert_src.has_value() && frag_src.has_value() && shader_src_opt.has_value()) {
+      GL3ShaderResource& shader_src = shader_src_opt.value();
+      shader_src.setVertexSourceGuid(vert_src.value().get().guid());
+      shader_src.setFragmentSourceGuid(frag_src.value().get().guid());
+      shader_src.ensureUpdated(resources);
+      _shaders.emplace(shader_src.guid(), createShader(shader_src));
+    }
+  }
+
+  {
+    std::optional<std::reference_wrapper<TextResource>> vert_src =
+        resources.getOrCreate<TextResource>("shaders/sprite_vert.glsl");
+    std::optional<std::reference_wrapper<TextResource>> frag_src =
+        resources.getOrCreate<TextResource>("shaders/sprite_frag.glsl");
+    std::optional<std::reference_wrapper<GL3ShaderResource>> shader_src_opt =
+        resources.getOrCreate<GL3ShaderResource>("shaders/sprite.glsl_shader", false);
+    if (vert_src.has_value() && frag_src.has_value() && shader_src_opt.has_value()) {
+      GL3ShaderResource& shader_src = shader_src_opt.value();
+      shader_src.setVertexSourceGuid(vert_src.value().get().guid());
+      shader_src.setFragmentSourceGuid(frag_src.value().get().guid());
+      shader_src.ensureUpdated(resources);
+      _shaders.emplace(shader_src.guid(), createShader(shader_src));
+      _sprite_shader = shader_src.guid();
+    }
+  }
 }
 
 GL3Renderer::~GL3Renderer() {
+  const GL3StateCache& state = GL3StateCache::get();
+  FEWI::info() << "GL state cache : " << state.skippedCalls() << " redundant calls skipped, "
+               << state.issuedCalls() << " issued";
+
   //_image_atlas->image().save();
   glDeleteBuffers(1, &_instance_vbo);
+  glDeleteVertexArrays(1, &_sprite_vao);
+  glDeleteBuffers(1, &_sprite_vbo);
+}
+
+// source images are 8 bits per channel, so float storage only costs memory and bandwidth
+static BufferFormat atlasFormat(BufferFormat requested, int channels) {
+  if (BufferFormat::RGBA32F == requested) {
+    return (1 == channels) ? BufferFormat::R8 : BufferFormat::RGBA8;
+  }
+  return requested;
 }
 
 GL3Renderer::AtlasInfo GL3Renderer::createAtlas(BufferFormat format, TextureFilter filter) {
   AtlasInfo atlas;
 
+  const GL3Texture::GLFormat gl_format = GL3Texture::glFormat(format);
   Vec2i atlas_size(4096 * 2);
   int out_width = 0;
   do {
     atlas_size = atlas_size / 2;
-    glTexImage2D(GL_PROXY_TEXTURE_2D, 0, GL_RGBA32F, atlas_size.x(), atlas_size.y(), 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, nullptr);
+    glTexImage2D(GL_PROXY_TEXTURE_2D, 0, gl_format.internal_format, atlas_size.x(),
+                 atlas_size.y(), 0, gl_format.format, gl_format.type, nullptr);
     glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &out_width);
   } while (out_width == 0);
 
@@ -107,49 +252,63 @@ GL3Renderer::AtlasInfo GL3Renderer::createAtlas(BufferFormat format, TextureFilt
   atlas.props->setFormat(format);
   atlas.props->setFilter(filter);
 
-  atlas.image = std::make_shared<ImageAtlas>("atlas.png", atlas_size.x(), atlas_size.y(), 4);
-  atlas.texture = std::make_shared<GL3Texture>(*atlas.props);
+  const int channels = (BufferFormat::R8 == format) ? 1 : 4;
+  atlas.image =
+      std::make_shared<ImageAtlas>("atlas.png", atlas_size.x(), atlas_size.y(), channels);
+  atlas.texture = std::make_shared<GL3Texture>(*atlas.props, _upload_queue);
 
   return atlas;
 }
 
 std::unique_ptr<Mesh> GL3Renderer::createMesh(const GUID& guid) {
-  return std::unique_ptr<Mesh>(new GL3Mesh(guid, _instance_vbo));
+  return std::unique_ptr<Mesh>(new GL3Mesh(guid, _instance_vbo, _upload_queue));
 }
 
 std::unique_ptr<Mesh> GL3Renderer::createMesh(const GUID& guid,
                                               std::span<const Vertex> vertices,
                                               std::span<const unsigned int> indices) {
-  return std::unique_ptr<Mesh>(new GL3Mesh(guid, vertices, indices, _instance_vbo));
+  return std::unique_ptr<Mesh>(new GL3Mesh(guid, vertices, indices, _instance_vbo, _upload_queue));
 }
 
 std::unique_ptr<Shader> GL3Renderer::createShader(const ShaderResourceInterface& res) {
   return std::unique_ptr<Shader>(new GL3Shader(res));
 }
 
+std::unique_ptr<UniformBuffer> GL3Renderer::createUniformBuffer() {
+  return std::make_unique<GL3UniformBuffer>();
+}
+
+size_t GL3Renderer::uniformBufferOffsetAlignment() const {
+  GLint alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  return static_cast<size_t>(alignment);
+}
+
 void GL3Renderer::useDrawOptions(const DrawOptions& options) {
-  if (options.depth_test) {
-    glEnable(GL_DEPTH_TEST);
-  } else {
-    glDisable(GL_DEPTH_TEST);
-  }
+  GL3StateCache::get().setDepthTest(options.depth_test);
 }
 
 int GL3Renderer::bindTexture(const Texture& texture) {
   const GUID binding_guid = texture.bindingGuid();
-  for (unsigned int i = 0; i < _texture_slots.size(); ++i) {
-    if (_texture_slots[i] == binding_guid) {
-      texture.bind(i);
-      return i;
+
+  int slot = 0;
+  if (const auto it = _texture_slot_lookup.find(binding_guid); it != _texture_slot_lookup.end()) {
+    slot = it->second;
+  } else {
+    slot = static_cast<int>(std::distance(
+        _texture_slot_last_use.begin(),
+        std::min_element(_texture_slot_last_use.begin(), _texture_slot_last_use.end())));
+    if (const auto evicted = _texture_slot_lookup.find(_texture_slots[slot]);
+        (evicted != _texture_slot_lookup.end()) && (evicted->second == slot)) {
+      _texture_slot_lookup.erase(evicted);
     }
+    _texture_slot_lookup.emplace(binding_guid, slot);
+    _texture_slots[slot] = binding_guid;
   }
 
-  int slot = _next_texture_slot;
-  _texture_slots[slot] = binding_guid;
+  _texture_slot_last_use[slot] = ++_texture_slot_clock;
   texture.bind(slot);
 
-  _next_texture_slot = (_next_texture_slot + 1) % _texture_slots.size();
-
   return slot;
 }
 
@@ -165,8 +324,22 @@ Ptr<Shader> GL3Renderer::getDefaultShader() const {
   return _shaders.at(GUID::null);
 }
 
+Ptr<Shader> GL3Renderer::getSpriteShader() const {
+  if (const auto it = _shaders.find(_sprite_shader);
+      (GUID::null != _sprite_shader) && (it != _shaders.end())) {
+    return it->second;
+  }
+  return nullptr;
+}
+
 Texture* GL3Renderer::createTexture(const TexturePropsResource& texture_props) {
-  const BufferFormat format = texture_props.getFormat();
+  int channels = 4;
+  if (const auto image_opt = _resources.getOrCreate<ImageResource>(texture_props.getSourceImage());
+      image_opt.has_value()) {
+    channels = image_opt.value().get().channels();
+  }
+
+  const BufferFormat format = atlasFormat(texture_props.getFormat(), channels);
   const TextureFilter filter = texture_props.getFilter();
 
   AtlasInfo* atlas = nullptr;
@@ -189,22 +362,77 @@ std::unique_ptr<Framebuffer> GL3Renderer::createFramebuffer(const GUID& guid,
   return std::make_unique<GL3Framebuffer>(guid, info);
 }
 
+unsigned int GL3Renderer::streamInstances(std::span<const CommonPerInstanceData> cpids) {
+  return streamBuffer(_instance_vbo, sizeof(CommonPerInstanceData), _instance_capacity,
+                      _instance_offset, cpids.data(), cpids.size());
+}
+
+unsigned int GL3Renderer::streamSprites(std::span<const SpriteInstanceData> sprites) {
+  return streamBuffer(_sprite_vbo, sizeof(SpriteInstanceData), _sprite_capacity, _sprite_offset,
+                      sprites.data(), sprites.size());
+}
+
+void GL3Renderer::uploadInstances(std::span<const CommonPerInstanceData> cpids) {
+  _frame_instances = cpids;
+  if (!cpids.empty()) {
+    _instance_offset = _instance_capacity;
+    _frame_first_instance = streamInstances(cpids);
+  }
+}
+
+void GL3Renderer::uploadSpriteInstances(std::span<const SpriteInstanceData> sprites) {
+  _frame_sprites = sprites;
+  if (!sprites.empty()) {
+    _sprite_offset = _sprite_capacity;
+    _frame_first_sprite = streamSprites(sprites);
+  }
+}
+
 void GL3Renderer::drawMeshInstances(const Mesh& mesh,
+                                    uint32_t lod,
                                     std::span<const CommonPerInstanceData> cpids) {
-  glBindBuffer(GL_ARRAY_BUFFER, _instance_vbo);
-  size_t iterations = static_cast<size_t>(std::ceil(cpids.size() / 100.f));
-  for (size_t i = 0; i < (iterations * 100); i += 100) {
-    size_t elements = ((cpids.size() - i) < 100) ? (cpids.size() - i) : 100;
-    glBufferData(GL_ARRAY_BUFFER, sizeof(CommonPerInstanceData) * elements, &cpids[i],
-                 GL_DYNAMIC_DRAW);
-    mesh.draw(static_cast<unsigned int>(elements));
+  if (cpids.empty()) {
+    return;
+  }
+
+  const long long frame_index = frameIndex(cpids, _frame_instances);
+  const unsigned int first_instance =
+      (0 <= frame_index) ? _frame_first_instance + static_cast<unsigned int>(frame_index)
+                         : streamInstances(cpids);
+
+  mesh.draw(static_cast<unsigned int>(cpids.size()), first_instance, lod);
+}
+
+void GL3Renderer::drawSpriteInstances(std::span<const SpriteInstanceData> sprites) {
+  static const bool base_instance_supported = (0 != gl3wIsSupported(4, 2));
+
+  if (sprites.empty()) {
+    return;
+  }
+
+  const long long frame_index = frameIndex(sprites, _frame_sprites);
+  const unsigned int first_instance =
+      (0 <= frame_index) ? _frame_first_sprite + static_cast<unsigned int>(frame_index)
+                         : streamSprites(sprites);
+  const GLsizei num_instances = static_cast<GLsizei>(sprites.size());
+
+  GL3StateCache::get().bindVertexArray(_sprite_vao);
+  if (base_instance_supported) {
+    glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, num_instances, first_instance);
+  } else {
+    if (_sprite_attrib_first_instance != first_instance) {
+      glBindBuffer(GL_ARRAY_BUFFER, _sprite_vbo);
+      pointSpriteAttributes(first_instance);
+      glBindBuffer(GL_ARRAY_BUFFER, 0);
+      _sprite_attrib_first_instance = first_instance;
+    }
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, num_instances);
   }
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void GL3Renderer::copyToScreen(Framebuffer& framebuffer) {
-  glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GL3Framebuffer&>(framebuffer).id());
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  GL3StateCache::get().bindReadFramebuffer(static_cast<GL3Framebuffer&>(framebuffer).id());
+  GL3StateCache::get().bindDrawFramebuffer(0);
 
   const Vec2f framebuffer_size = framebuffer.getSize();
   const Vec2i& screen_size = screenSize();
@@ -227,6 +455,14 @@ void GL3Renderer::blit(Framebuffer& dst, const Framebuffer& src) {
   static_cast<GL3Framebuffer&>(dst).blit(static_cast<const GL3Framebuffer&>(src));
 }
 
+void GL3Renderer::beginGPUTimer(std::string name) {
+  _gpu_timer->begin(std::move(name));
+}
+
+void GL3Renderer::endGPUTimer() {
+  _gpu_timer->end();
+}
+
 void GL3Renderer::preRender(Session& session, Resources& resources) {
   Renderer::preRender(session, resources);
 
@@ -234,7 +470,10 @@ void GL3Renderer::preRender(Session& session, Resources& resources) {
     const uint64_t prev_gen = atlas.image->gen();
     atlas.image->update(resources);
     if (prev_gen != atlas.image->gen()) {
-      atlas.texture->update(atlas.image->image());
+      for (const ImageAtlas::Region& region : atlas.image->getDirtyRegions()) {
+        atlas.texture->updateRegion(atlas.image->image(), region.position, region.size);
+      }
+      atlas.image->clearDirtyRegions();
 
       const auto& rejected_images = atlas.image->getRejectedImages();
       if (!rejected_images.empty()) {
@@ -260,8 +499,13 @@ void GL3Renderer::preRender(Session& session, Resources& resources) {
     GL3Shader& shader = static_cast<GL3Shader&>(*shader_ptr.get());
     shader.checkAndApplyResourceUpdates(resources);
   }
+
+  _upload_queue->flush();
 }
 
 void GL3Renderer::render() {
   Renderer::render();
+  _gpu_timer->endFrame();
+  _frame_instances = {};
+  _frame_sprites = {};
 }
\ No newline at end of file
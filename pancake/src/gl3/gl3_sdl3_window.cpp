@@ -1,5 +1,6 @@
 #include "gl3/gl3_sdl3_window.hpp"
 
+#include "gl3/gl3_state_cache.hpp"
 #include "util/fewi.hpp"
 
 #include "GL/gl3w.h"
@@ -61,6 +62,7 @@ void GL3SDL3Window::flip() {
 #if defined(PANCAKE_ENABLE_IMGUI)
   ImGui::Render();
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  GL3StateCache::get().invalidate();
 #endif
 
   SDL_GL_SwapWindow(_window);
@@ -1,5 +1,7 @@
 #include "gl3/gl3_shader.hpp"
 
+#include "gl3/gl3_program_cache.hpp"
+#include "gl3/gl3_state_cache.hpp"
 #include "resources/text_resource.hpp"
 #include "util/fewi.hpp"
 
@@ -10,8 +12,16 @@ using namespace pancake;
 static const size_t INFO_LOG_SIZE = 512;
 static char info_log[INFO_LOG_SIZE];
 
+static const int UNRESOLVED_LOCATION = -2;
+
 GL3Shader::GL3Shader(const ShaderResourceInterface& res)
-    : Shader(res.asResource().guid()), _program(0) {
+    : Shader(res.asResource().guid()),
+      _vert_shader(0),
+      _frag_shader(0),
+      _program(0),
+      _vert_source(),
+      _frag_source(),
+      _uniform_locations() {
   setResourceGuid<ShaderResourceInterface, ShaderSourceTag>(guid());
 }
 
@@ -19,81 +29,150 @@ GL3Shader::~GL3Shader() {
   glDeleteShader(_vert_shader);
   glDeleteShader(_frag_shader);
   glDeleteProgram(_program);
+  GL3StateCache::get().invalidate();
 }
 
-void GL3Shader::compileVertexSource(std::string_view source) {
-  glDeleteShader(_vert_shader);
-  _vert_shader = glCreateShader(GL_VERTEX_SHADER);
+static unsigned int compileShader(unsigned int shader,
+                                  GLenum type,
+                                  const std::string& source,
+                                  std::string_view name) {
+  glDeleteShader(shader);
+  shader = glCreateShader(type);
 
-  const char* vert_cstr = source.data();
-  glShaderSource(_vert_shader, 1, &vert_cstr, NULL);
-  glCompileShader(_vert_shader);
+  const char* cstr = source.c_str();
+  glShaderSource(shader, 1, &cstr, NULL);
+  glCompileShader(shader);
 
   int success;
-  glGetShaderiv(_vert_shader, GL_COMPILE_STATUS, &success);
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
   if (!success) {
-    glGetShaderInfoLog(_vert_shader, INFO_LOG_SIZE, NULL, info_log);
-    FEWI::error() << "Failed to compile vertex shader! : " << info_log;
+    glGetShaderInfoLog(shader, INFO_LOG_SIZE, NULL, info_log);
+    FEWI::error() << "Failed to compile " << name << " shader! : " << info_log;
   }
+  return shader;
 }
 
-void GL3Shader::compileFragmentSource(std::string_view source) {
-  glDeleteShader(_frag_shader);
-  _frag_shader = glCreateShader(GL_FRAGMENT_SHADER);
-
-  const char* frag_cstr = source.data();
-  glShaderSource(_frag_shader, 1, &frag_cstr, NULL);
-  glCompileShader(_frag_shader);
+void GL3Shader::setVertexSource(std::string_view source) {
+  _vert_source = source;
+}
 
-  int success;
-  glGetShaderiv(_frag_shader, GL_COMPILE_STATUS, &success);
-  if (!success) {
-    glGetShaderInfoLog(_frag_shader, INFO_LOG_SIZE, NULL, info_log);
-    FEWI::error() << "Failed to compile fragment shader! : " << info_log;
-  }
+void GL3Shader::setFragmentSource(std::string_view source) {
+  _frag_source = source;
 }
 
 void GL3Shader::linkProgram() {
   glDeleteProgram(_program);
+  GL3StateCache::get().invalidate();
   _program = glCreateProgram();
+  _uniform_locations.clear();
+
+  GL3ProgramCache& cache = GL3ProgramCache::get();
+  if (cache.load(guid(), _program, _vert_source, _frag_source)) {
+    reflectUniformBlocks();
+    return;
+  }
+
+  _vert_shader = compileShader(_vert_shader, GL_VERTEX_SHADER, _vert_source, "vertex");
+  _frag_shader = compileShader(_frag_shader, GL_FRAGMENT_SHADER, _frag_source, "fragment");
 
   glAttachShader(_program, _vert_shader);
   glAttachShader(_program, _frag_shader);
+  cache.prepare(_program);
   glLinkProgram(_program);
 
+  reflectUniformBlocks();
+
   int success;
   glGetProgramiv(_program, GL_LINK_STATUS, &success);
   if (!success) {
     glGetProgramInfoLog(_program, INFO_LOG_SIZE, NULL, info_log);
     FEWI::error() << "Failed to link shader program! : " << info_log;
+  } else {
+    cache.store(guid(), _program, _vert_source, _frag_source);
   }
 }
 
 void GL3Shader::use() const {
-  glUseProgram(_program);
+  GL3StateCache::get().useProgram(_program);
+}
+
+void GL3Shader::reflectUniformBlocks() {
+  static const char* block_names[] = {"PancakeFrame", "PancakeCamera", "PancakeMaterial",
+                                      "PancakeLights"};
+
+  for (GLuint binding = 0; binding < 4; ++binding) {
+    std::optional<UniformBlockLayout>& layout = _uniform_block_layouts[binding];
+    layout.reset();
+
+    const GLuint block_index = glGetUniformBlockIndex(_program, block_names[binding]);
+    if (GL_INVALID_INDEX == block_index) {
+      continue;
+    }
+    glUniformBlockBinding(_program, block_index, binding);
+
+    GLint size = 0;
+    GLint num_uniforms = 0;
+    glGetActiveUniformBlockiv(_program, block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+    glGetActiveUniformBlockiv(_program, block_index, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS,
+                              &num_uniforms);
+
+    std::vector<GLint> indices(num_uniforms);
+    glGetActiveUniformBlockiv(_program, block_index, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES,
+                              indices.data());
+
+    std::vector<GLint> offsets(num_uniforms);
+    glGetActiveUniformsiv(_program, num_uniforms, reinterpret_cast<const GLuint*>(indices.data()),
+                          GL_UNIFORM_OFFSET, offsets.data());
+
+    layout.emplace();
+    layout->size = static_cast<size_t>(size);
+    for (GLint i = 0; i < num_uniforms; ++i) {
+      GLsizei length = 0;
+      glGetActiveUniformName(_program, indices[i], INFO_LOG_SIZE, &length, info_log);
+      layout->offsets.emplace_back(UniformId(std::string_view(info_log, length)),
+                                   static_cast<size_t>(offsets[i]));
+    }
+  }
+}
+
+int GL3Shader::uniformLocation(const UniformId& id) const {
+  if (_uniform_locations.size() <= id.index()) {
+    _uniform_locations.resize(id.index() + 1, UNRESOLVED_LOCATION);
+  }
+
+  int& location = _uniform_locations[id.index()];
+  if (UNRESOLVED_LOCATION == location) {
+    location = glGetUniformLocation(_program, id.name().data());
+  }
+  return location;
+}
+
+void GL3Shader::setUniform(const UniformId& id, int value) const {
+  glUniform1i(uniformLocation(id), value);
 }
 
-void GL3Shader::setUniform(std::string_view name, int value) const {
-  glUniform1i(glGetUniformLocation(_program, name.data()), value);
+void GL3Shader::setUniform(const UniformId& id, float value) const {
+  glUniform1f(uniformLocation(id), value);
 }
 
-void GL3Shader::setUniform(std::string_view name, float value) const {
-  glUniform1f(glGetUniformLocation(_program, name.data()), value);
+void GL3Shader::setUniform(const UniformId& id, const Vec3f& value) const {
+  glUniform3f(uniformLocation(id), value.x(), value.y(), value.z());
 }
 
-void GL3Shader::setUniform(std::string_view name, const Vec3f& value) const {
-  glUniform3f(glGetUniformLocation(_program, name.data()), value.x(), value.y(), value.z());
+void GL3Shader::setUniform(const UniformId& id, const Vec4f& value) const {
+  glUniform4f(uniformLocation(id), value.x(), value.y(), value.z(), value.w());
 }
 
-void GL3Shader::setUniform(std::string_view name, const Vec4f& value) const {
-  glUniform4f(glGetUniformLocation(_program, name.data()), value.x(), value.y(), value.z(),
-              value.w());
+void GL3Shader::setUniform(const UniformId& id, const Vec4u& value) const {
+  glUniform4uiv(uniformLocation(id), 1, &value.m[0][0]);
 }
 
-void GL3Shader::setUniform(std::string_view name, const Vec4u& value) const {
-  glUniform4uiv(glGetUniformLocation(_program, name.data()), 1, &value.m[0][0]);
+void GL3Shader::setUniform(const UniformId& id, const Mat4f& value) const {
+  glUniformMatrix4fv(uniformLocation(id), 1, false, &(value.m[0][0]));
 }
 
-void GL3Shader::setUniform(std::string_view name, const Mat4f& value) const {
-  glUniformMatrix4fv(glGetUniformLocation(_program, name.data()), 1, false, &(value.m[0][0]));
+const UniformBlockLayout* GL3Shader::getUniformBlockLayout(UniformBlock block) const {
+  const std::optional<UniformBlockLayout>& layout =
+      _uniform_block_layouts[static_cast<size_t>(block)];
+  return layout.has_value() ? &layout.value() : nullptr;
 }
\ No newline at end of file
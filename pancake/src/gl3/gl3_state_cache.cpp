@@ -0,0 +1,116 @@
+#include "gl3/gl3_state_cache.hpp"
+
+#include "util/assert.hpp"
+
+#include "GL/gl3w.h"
+
+using namespace pancake;
+
+GL3StateCache::GL3StateCache() : _issued_calls(0), _skipped_calls(0) {
+  invalidate();
+}
+
+GL3StateCache& GL3StateCache::get() {
+  static GL3StateCache cache;
+  return cache;
+}
+
+template <typename T>
+bool GL3StateCache::change(T& current, T value) {
+  if (current == value) {
+    ++_skipped_calls;
+    return false;
+  }
+  current = value;
+  ++_issued_calls;
+  return true;
+}
+
+void GL3StateCache::useProgram(unsigned int program) {
+  if (change(_program, program)) {
+    glUseProgram(program);
+  }
+}
+
+void GL3StateCache::bindVertexArray(unsigned int vao) {
+  if (change(_vao, vao)) {
+    glBindVertexArray(vao);
+  }
+}
+
+void GL3StateCache::bindReadFramebuffer(unsigned int fbo) {
+  if (change(_read_framebuffer, fbo)) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+  }
+}
+
+void GL3StateCache::bindDrawFramebuffer(unsigned int fbo) {
+  if (change(_draw_framebuffer, fbo)) {
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo);
+  }
+}
+
+void GL3StateCache::bindFramebuffer(unsigned int fbo) {
+  if ((_read_framebuffer != fbo) && (_draw_framebuffer != fbo)) {
+    _read_framebuffer = fbo;
+    _draw_framebuffer = fbo;
+    ++_issued_calls;
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+  } else {
+    bindReadFramebuffer(fbo);
+    bindDrawFramebuffer(fbo);
+  }
+}
+
+void GL3StateCache::bindTexture(unsigned int unit, unsigned int texture) {
+  ensure(unit < MAX_TEXTURE_UNITS);
+  if (_textures[unit] == texture) {
+    ++_skipped_calls;
+    return;
+  }
+  if (change(_active_unit, unit)) {
+    glActiveTexture(GL_TEXTURE0 + unit);
+  }
+  bindTexture(texture);
+}
+
+void GL3StateCache::bindTexture(unsigned int texture) {
+  if (UNKNOWN == _active_unit) {
+    bindTexture(0, texture);
+    return;
+  }
+  if (change(_textures[_active_unit], texture)) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+  }
+}
+
+void GL3StateCache::setDepthTest(bool enabled) {
+  if (change(_depth_test, enabled ? 1u : 0u)) {
+    enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+  }
+}
+
+void GL3StateCache::setBlend(bool enabled) {
+  if (change(_blend, enabled ? 1u : 0u)) {
+    enabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+  }
+}
+
+void GL3StateCache::invalidate() {
+  _program = UNKNOWN;
+  _vao = UNKNOWN;
+  _read_framebuffer = UNKNOWN;
+  _draw_framebuffer = UNKNOWN;
+  _active_unit = UNKNOWN;
+  _textures.fill(UNKNOWN);
+  _depth_test = UNKNOWN;
+  _blend = UNKNOWN;
+}
+
+uint64_t GL3StateCache::issuedCalls() const {
+  return _issued_calls;
+}
+
+uint64_t GL3StateCache::skippedCalls() const {
+  return _skipped_calls;
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "gl3/gl3_texture.hpp"
 
+#include "gl3/gl3_state_cache.hpp"
+#include "gl3/gl3_upload_queue.hpp"
 #include "resources/image_resource.hpp"
 #include "resources/texture_props_resource.hpp"
 #include "util/fewi.hpp"
@@ -8,44 +10,86 @@
 
 using namespace pancake;
 
-GL3Texture::GL3Texture(const TexturePropsResource& texture_props)
-    : Texture(texture_props), _tex(0) {
+static GLenum pixelFormat(int channels) {
+  switch (channels) {
+    case 1:
+      return GL_RED;
+    case 2:
+      return GL_RG;
+    case 3:
+      return GL_RGB;
+    default:
+      return GL_RGBA;
+  }
+}
+
+GL3Texture::GL3Texture(const TexturePropsResource& texture_props,
+                       Ptr<GL3UploadQueue> upload_queue)
+    : Texture(texture_props), _tex(0), _upload_queue(upload_queue), _pending_uploads(0) {
   glGenTextures(1, &_tex);
   update(texture_props);
 }
 
 GL3Texture::~GL3Texture() {
+  if (nullptr != _upload_queue) {
+    _upload_queue->cancel(this);
+  }
   glDeleteTextures(1, &_tex);
+  GL3StateCache::get().invalidate();
 }
 
 void GL3Texture::bind(int slot) const {
-  glActiveTexture(GL_TEXTURE0 + slot);
-  glBindTexture(GL_TEXTURE_2D, _tex);
+  // region updates still queued would leave this draw sampling stale or uninitialised texels
+  if (0 < _pending_uploads) {
+    _upload_queue->flush(this);
+  }
+  GL3StateCache::get().bindTexture(slot, _tex);
 }
 
 unsigned int GL3Texture::getId() const {
   return _tex;
 }
 
+GL3Texture::GLFormat GL3Texture::glFormat(BufferFormat format) {
+  switch (format) {
+    case BufferFormat::RGBA32F:
+      return {GL_RGBA32F, GL_RGBA, GL_UNSIGNED_BYTE};
+    case BufferFormat::RGBA32UI:
+      return {GL_RGBA32UI, GL_RGBA_INTEGER, GL_UNSIGNED_INT};
+    case BufferFormat::RGBA8:
+      return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
+    case BufferFormat::SRGB8_A8:
+      return {GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE};
+    case BufferFormat::R8:
+      return {GL_R8, GL_RED, GL_UNSIGNED_BYTE};
+    default:
+      FEWI::error() << "Unsupported buffer format!";
+      return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
+  }
+}
+
 void GL3Texture::update(const TexturePropsResource& texture_props) {
   Texture::update(texture_props);
 
+  // pending uploads target the storage being replaced
+  if (nullptr != _upload_queue) {
+    _upload_queue->cancel(this);
+    _pending_uploads = 0;
+  }
+
   const Vec2i& size = texture_props.getSize();
 
-  glBindTexture(GL_TEXTURE_2D, _tex);
+  GL3StateCache::get().bindTexture(_tex);
 
-  switch (texture_props.getFormat()) {
-    case BufferFormat::RGBA32F:
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, size.x(), size.y(), 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                   nullptr);
-      break;
-    case BufferFormat::RGBA32UI:
-      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32UI, size.x(), size.y(), 0, GL_RGBA_INTEGER,
-                   GL_UNSIGNED_INT, nullptr);
-      break;
-    default:
-      FEWI::error() << "Unsupported buffer format!";
-      break;
+  const GLFormat gl_format = glFormat(texture_props.getFormat());
+  glTexImage2D(GL_TEXTURE_2D, 0, gl_format.internal_format, size.x(), size.y(), 0, gl_format.format,
+               gl_format.type, nullptr);
+
+  // single channel images read as (r, 1, 1, 1), as they did when blitted into rgba storage, which
+  // filled the missing channels with 255
+  if (BufferFormat::R8 == texture_props.getFormat()) {
+    const GLint swizzle[] = {GL_RED, GL_ONE, GL_ONE, GL_ONE};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
   }
 
   GLenum err = glGetError();
@@ -66,17 +110,33 @@ void GL3Texture::update(const TexturePropsResource& texture_props) {
       FEWI::error() << "Unsupported texture filter!";
   }
 
-  glBindTexture(GL_TEXTURE_2D, 0);
-
   scheduleImageUpdate();
 }
 
 void GL3Texture::update(const ImageResource& image) {
   Texture::update(image);
+  updateRegion(image, Vec2i::zeros(), image.size());
+}
+
+void GL3Texture::updateRegion(const ImageResource& image,
+                              const Vec2i& position,
+                              const Vec2i& size) {
+  const int channels = image.channels();
+  if (nullptr != _upload_queue) {
+    ++_pending_uploads;
+    _upload_queue->queueTexture(this, _tex, pixelFormat(channels), image, position, size,
+                                [this]() { --_pending_uploads; });
+    return;
+  }
+
+  const unsigned char* data =
+      image.data() + (((position.y() * image.width()) + position.x()) * channels);
 
-  unsigned int channels = image.channels();
-  glBindTexture(GL_TEXTURE_2D, _tex);
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width(), image.height(),
-                  channels == 3 ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, image.data());
-  glBindTexture(GL_TEXTURE_2D, 0);
+  GL3StateCache::get().bindTexture(_tex);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, image.width());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, position.x(), position.y(), size.x(), size.y(),
+                  pixelFormat(channels), GL_UNSIGNED_BYTE, data);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 }
\ No newline at end of file
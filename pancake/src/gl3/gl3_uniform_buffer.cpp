@@ -0,0 +1,36 @@
+#include "gl3/gl3_uniform_buffer.hpp"
+
+#include "GL/gl3w.h"
+
+using namespace pancake;
+
+// updates up to this size are written in place, orphaning the whole store for them costs the
+// driver a fresh allocation while the write itself is no more than a stall on a few bytes
+static const size_t MAX_IN_PLACE_UPDATE = 1024;
+
+GL3UniformBuffer::GL3UniformBuffer() : _ubo(0), _size(0) {
+  glGenBuffers(1, &_ubo);
+}
+
+GL3UniformBuffer::~GL3UniformBuffer() {
+  glDeleteBuffers(1, &_ubo);
+}
+
+void GL3UniformBuffer::update(std::span<const std::byte> data) {
+  glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+  if (_size < data.size()) {
+    glBufferData(GL_UNIFORM_BUFFER, data.size(), data.data(), GL_DYNAMIC_DRAW);
+    _size = data.size();
+  } else if (!data.empty()) {
+    if (MAX_IN_PLACE_UPDATE < data.size()) {
+      glBufferData(GL_UNIFORM_BUFFER, _size, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, data.size(), data.data());
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void GL3UniformBuffer::bind(UniformBlock block, size_t offset, size_t size) const {
+  glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(block), _ubo,
+                    static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "gl3/gl3_upload_queue.hpp"
+
+#include "gl3/gl3_state_cache.hpp"
+#include "resources/image_resource.hpp"
+#include "util/fewi.hpp"
+
+#include "GL/gl3w.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace pancake;
+
+static const size_t STAGING_ALIGNMENT = 16;
+
+static size_t alignStaging(size_t offset) {
+  return (offset + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+}
+
+GL3UploadQueue::GL3UploadQueue(size_t frame_budget)
+    : _frame_budget(frame_budget), _staging_buffer(0), _staging_capacity(0), _pending_bytes(0) {
+  glGenBuffers(1, &_staging_buffer);
+}
+
+GL3UploadQueue::~GL3UploadQueue() {
+  glDeleteBuffers(1, &_staging_buffer);
+}
+
+void GL3UploadQueue::queueTexture(const void* owner,
+                                  unsigned int texture,
+                                  unsigned int format,
+                                  const ImageResource& image,
+                                  const Vec2i& position,
+                                  const Vec2i& size,
+                                  std::function<void()> on_complete) {
+  const size_t row_bytes = static_cast<size_t>(size.x()) * image.channels();
+  const size_t image_row_bytes = static_cast<size_t>(image.width()) * image.channels();
+
+  Upload& upload = _uploads.emplace_back(owner, texture, format, position, size, 0, 0,
+                                         std::vector<std::byte>(row_bytes * size.y()),
+                                         std::move(on_complete));
+
+  // rows are packed tightly so only the region itself is staged
+  const unsigned char* src =
+      image.data() + (position.y() * image_row_bytes) + (position.x() * image.channels());
+  for (int row = 0; row < size.y(); ++row) {
+    std::memcpy(upload.data.data() + (row * row_bytes), src + (row * image_row_bytes), row_bytes);
+  }
+
+  _pending_bytes += upload.data.size();
+}
+
+void GL3UploadQueue::queueBuffer(const void* owner,
+                                 unsigned int buffer,
+                                 size_t offset,
+                                 std::span<const std::byte> bytes,
+                                 std::function<void()> on_complete) {
+  _uploads.emplace_back(owner, 0, 0, Vec2i::zeros(), Vec2i::zeros(), buffer, offset,
+                        std::vector<std::byte>(bytes.begin(), bytes.end()),
+                        std::move(on_complete));
+  _pending_bytes += bytes.size();
+}
+
+void GL3UploadQueue::cancel(const void* owner) {
+  std::erase_if(_uploads, [this, owner](const Upload& upload) {
+    if (upload.owner == owner) {
+      _pending_bytes -= upload.data.size();
+      return true;
+    }
+    return false;
+  });
+}
+
+void GL3UploadQueue::flush() {
+  if (_uploads.empty()) {
+    return;
+  }
+
+  size_t num_uploads = 0;
+  size_t staged_bytes = 0;
+  for (const Upload& upload : _uploads) {
+    const size_t end = alignStaging(staged_bytes) + upload.data.size();
+    if ((0 < num_uploads) && (_frame_budget < end)) {
+      break;
+    }
+    staged_bytes = end;
+    ++num_uploads;
+  }
+
+  submit(num_uploads, staged_bytes);
+}
+
+void GL3UploadQueue::flush(const void* owner) {
+  // moving the owner's uploads to the front keeps their order and lets them stage as usual
+  const auto end = std::stable_partition(
+      _uploads.begin(), _uploads.end(),
+      [owner](const Upload& upload) { return upload.owner == owner; });
+  const size_t num_uploads = static_cast<size_t>(std::distance(_uploads.begin(), end));
+  if (0 == num_uploads) {
+    return;
+  }
+
+  size_t staged_bytes = 0;
+  for (size_t i = 0; i < num_uploads; ++i) {
+    staged_bytes = alignStaging(staged_bytes) + _uploads[i].data.size();
+  }
+
+  submit(num_uploads, staged_bytes);
+}
+
+void GL3UploadQueue::submit(size_t num_uploads, size_t staged_bytes) {
+  if (0 < staged_bytes) {
+    if (!stage(num_uploads, staged_bytes)) {
+      return;
+    }
+  }
+
+  for (size_t i = 0; i < num_uploads; ++i) {
+    Upload& upload = _uploads.front();
+    _pending_bytes -= upload.data.size();
+    if (upload.on_complete) {
+      upload.on_complete();
+    }
+    _uploads.pop_front();
+  }
+}
+
+bool GL3UploadQueue::stage(size_t num_uploads, size_t staged_bytes) {
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _staging_buffer);
+
+  // orphaning the previous frame's storage lets the driver keep it alive for in flight copies
+  _staging_capacity = (std::max)(_staging_capacity, staged_bytes);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, _staging_capacity, nullptr, GL_STREAM_DRAW);
+
+  std::byte* staging = static_cast<std::byte*>(glMapBufferRange(
+      GL_PIXEL_UNPACK_BUFFER, 0, staged_bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (nullptr == staging) {
+    FEWI::error() << "Failed to map upload staging buffer!";
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return false;
+  }
+
+  std::vector<size_t> offsets;
+  offsets.reserve(num_uploads);
+  size_t offset = 0;
+  for (size_t i = 0; i < num_uploads; ++i) {
+    const Upload& upload = _uploads[i];
+    offset = alignStaging(offset);
+    std::memcpy(staging + offset, upload.data.data(), upload.data.size());
+    offsets.push_back(offset);
+    offset += upload.data.size();
+  }
+
+  if (GL_FALSE == glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+    FEWI::warn() << "Upload staging buffer was corrupted, retrying next frame";
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return false;
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glBindBuffer(GL_COPY_READ_BUFFER, _staging_buffer);
+
+  for (size_t i = 0; i < num_uploads; ++i) {
+    const Upload& upload = _uploads[i];
+    if (0 != upload.texture) {
+      GL3StateCache::get().bindTexture(upload.texture);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, upload.position.x(), upload.position.y(), upload.size.x(),
+                      upload.size.y(), upload.format, GL_UNSIGNED_BYTE,
+                      reinterpret_cast<void*>(offsets[i]));
+    } else if (!upload.data.empty()) {
+      glBindBuffer(GL_COPY_WRITE_BUFFER, upload.buffer);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offsets[i], upload.offset,
+                          upload.data.size());
+    }
+  }
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  return true;
+}
+
+size_t GL3UploadQueue::pendingBytes() const {
+  return _pending_bytes;
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include "graphics/draw_queue.hpp"
+
+#include "util/assert.hpp"
+#include "util/fewi.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <tuple>
+
+using namespace pancake;
+
+void pancake::radixSort(std::vector<SortKey>& keys, std::vector<SortKey>& scratch) {
+  if (keys.size() < 2) {
+    return;
+  }
+
+  scratch.resize(keys.size());
+
+  size_t counts[sizeof(uint64_t)][256] = {};
+  for (const SortKey& sort_key : keys) {
+    for (size_t pass = 0; pass < sizeof(uint64_t); ++pass) {
+      ++counts[pass][(sort_key.key >> (pass * 8)) & 0xFF];
+    }
+  }
+
+  for (size_t pass = 0; pass < sizeof(uint64_t); ++pass) {
+    const size_t shift = pass * 8;
+    size_t* count = counts[pass];
+    if (count[(keys.front().key >> shift) & 0xFF] == keys.size()) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < 256; ++i) {
+      const size_t num = count[i];
+      count[i] = offset;
+      offset += num;
+    }
+
+    for (const SortKey& sort_key : keys) {
+      scratch[count[(sort_key.key >> shift) & 0xFF]++] = sort_key;
+    }
+    keys.swap(scratch);
+  }
+}
+
+// key layout, most to least significant :
+// stage (16) | framebuffer (6) | options (1) | shader (9) | camera (4) | material (9) | inputs (8)
+// | mesh (8) | lod (2) | sprite (1)
+// slots beyond their field width share key bits with lower ones, see sortPackets()
+uint64_t DrawQueue::Packet::key() const {
+  using Limits = std::numeric_limits<int16_t>;
+  ensure((Limits::min() <= stage) && (stage <= Limits::max()));
+
+  const uint64_t stage_bits = static_cast<uint64_t>(stage - Limits::min());
+  const uint64_t options_bits = options.depth_test ? 1 : 0;
+
+  return (stage_bits << 48) | ((static_cast<uint64_t>(framebuffer) & 0x3F) << 42) |
+         (options_bits << 41) | ((static_cast<uint64_t>(shader) & 0x1FF) << 32) |
+         ((static_cast<uint64_t>(camera) & 0xF) << 28) |
+         ((static_cast<uint64_t>(material) & 0x1FF) << 19) |
+         ((static_cast<uint64_t>(inputs) & 0xFF) << 11) |
+         ((static_cast<uint64_t>(mesh) & 0xFF) << 3) | ((static_cast<uint64_t>(lod) & 0x3) << 1) |
+         (sprite ? 1 : 0);
+}
+
+bool DrawQueue::Packet::keyOverflows() const {
+  return (0x3F < framebuffer) || (0x1FF < shader) || (0xF < camera) || (0x1FF < material) ||
+         (0xFF < inputs) || (0xFF < mesh) || (0x3 < lod);
+}
+
+bool DrawQueue::Packet::orderedBefore(const Packet& other) const {
+  return std::tie(stage, framebuffer, options, shader, camera, material, inputs, mesh, lod,
+                  sprite) < std::tie(other.stage, other.framebuffer, other.options, other.shader,
+                                     other.camera, other.material, other.inputs, other.mesh,
+                                     other.lod, other.sprite);
+}
+
+bool DrawQueue::Packet::batchesWith(const Packet& other) const {
+  return (stage == other.stage) && (options == other.options) &&
+         (framebuffer == other.framebuffer) && (shader == other.shader) &&
+         (camera == other.camera) && (material == other.material) && (inputs == other.inputs) &&
+         (mesh == other.mesh) && (lod == other.lod) && (sprite == other.sprite);
+}
+
+DrawQueue::Packet DrawQueue::makePacket(int stage,
+                                        const GUID& framebuffer,
+                                        const DrawOptions& options,
+                                        const GUID& shader,
+                                        const Ptr<const ShaderInputBlock>& inputs,
+                                        const GUID& mesh,
+                                        uint32_t camera,
+                                        const std::optional<GUID>& material,
+                                        uint32_t lod,
+                                        uint32_t instance) {
+  return Packet(stage, options, _framebuffers.get(framebuffer), _shaders.get(shader), camera,
+                material.has_value() ? _materials.get(*material) : NO_MATERIAL,
+                _inputs.get(inputs), _meshes.get(mesh), lod, false, instance);
+}
+
+void DrawQueue::push(int stage,
+                     const GUID& framebuffer,
+                     const DrawOptions& options,
+                     const GUID& shader,
+                     const Ptr<const ShaderInputBlock>& inputs,
+                     const GUID& mesh,
+                     const CommonPerInstanceData& cpid,
+                     uint32_t camera,
+                     const std::optional<GUID>& material,
+                     uint32_t lod) {
+  _packets.push_back(makePacket(stage, framebuffer, options, shader, inputs, mesh, camera,
+                                material, lod, static_cast<uint32_t>(_instances.size())));
+  _instances.push_back(cpid);
+}
+
+void DrawQueue::pushSprite(int stage,
+                           const GUID& framebuffer,
+                           const DrawOptions& options,
+                           const GUID& shader,
+                           const Ptr<const ShaderInputBlock>& inputs,
+                           const SpriteInstanceData& sprite,
+                           uint32_t camera,
+                           const GUID& material) {
+  _packets.emplace_back(stage, options, _framebuffers.get(framebuffer), _shaders.get(shader),
+                        camera, _materials.get(material), _inputs.get(inputs), 0, 0, true,
+                        static_cast<uint32_t>(_sprite_instances.size()));
+  _sprite_instances.push_back(sprite);
+}
+
+uint32_t DrawQueue::pushRetained(int stage,
+                                 const GUID& framebuffer,
+                                 const DrawOptions& options,
+                                 const GUID& shader,
+                                 const Ptr<const ShaderInputBlock>& inputs,
+                                 const GUID& mesh,
+                                 const CommonPerInstanceData& cpid,
+                                 uint32_t camera,
+                                 const std::optional<GUID>& material,
+                                 uint32_t lod) {
+  // retained slots come first so clear() can truncate the tables back to them
+  ensure(_packets.empty());
+
+  const uint32_t packet = static_cast<uint32_t>(_retained_packets.size());
+  _retained_packets.push_back(makePacket(stage, framebuffer, options, shader, inputs, mesh,
+                                         camera, material, lod,
+                                         static_cast<uint32_t>(_retained_instances.size())));
+  _retained_instances.push_back(cpid);
+  _retained_slots = {_framebuffers.size(), _shaders.size(), _materials.size(), _inputs.size(),
+                     _meshes.size()};
+  _retained_sorted = false;
+  return packet;
+}
+
+void DrawQueue::patchRetained(uint32_t packet, const CommonPerInstanceData& cpid) {
+  _retained_instances[_retained_packets[packet].instance] = cpid;
+  if (_retained_sorted) {
+    _sorted_instances[_retained_instance_slots[packet]] = cpid;
+  }
+}
+
+void DrawQueue::setRetainedLod(uint32_t packet, uint32_t lod) {
+  if (_retained_packets[packet].lod != lod) {
+    _retained_packets[packet].lod = lod;
+    _retained_sorted = false;
+  }
+}
+
+uint32_t DrawQueue::retainedCamera(uint32_t packet) const {
+  return _retained_packets[packet].camera;
+}
+
+uint32_t DrawQueue::retainedLod(uint32_t packet) const {
+  return _retained_packets[packet].lod;
+}
+
+void DrawQueue::sortPackets(std::span<const Packet> packets,
+                            std::span<const CommonPerInstanceData> instances,
+                            std::vector<Batch>& batches,
+                            std::vector<uint32_t>* instance_slots) {
+  _keys.clear();
+  _keys.reserve(packets.size());
+  bool overflow = false;
+  for (uint32_t i = 0; i < packets.size(); ++i) {
+    _keys.emplace_back(packets[i].key(), i);
+    overflow |= packets[i].keyOverflows();
+  }
+
+  radixSort(_keys, _scratch);
+
+  // overflowing slots leave different packets with equal keys interleaved in submission order,
+  // so runs of equal keys are sorted again on their full slots to keep identical packets together
+  if (overflow) {
+    static bool warned = false;
+    if (!warned) {
+      FEWI::warn() << "Draw queue slots overflow their sort key fields, colliding packets are "
+                      "sorted again on their full slots";
+      warned = true;
+    }
+
+    for (auto first = _keys.begin(); first != _keys.end();) {
+      const auto last = std::find_if(first, _keys.end(), [&](const SortKey& sort_key) {
+        return sort_key.key != first->key;
+      });
+      if (1 < std::distance(first, last)) {
+        std::stable_sort(first, last, [&](const SortKey& a, const SortKey& b) {
+          return packets[a.index].orderedBefore(packets[b.index]);
+        });
+      }
+      first = last;
+    }
+  }
+
+  batches.clear();
+  const Packet* prev_packet = nullptr;
+  for (const SortKey& sort_key : _keys) {
+    const Packet& packet = packets[sort_key.index];
+    if ((nullptr == prev_packet) || !packet.batchesWith(*prev_packet)) {
+      const size_t first_instance =
+          packet.sprite ? _sorted_sprite_instances.size() : _sorted_instances.size();
+      batches.emplace_back(packet.stage, packet.options, packet.framebuffer, packet.shader,
+                           packet.camera, packet.material, packet.inputs, packet.mesh, packet.lod,
+                           packet.sprite, static_cast<uint32_t>(first_instance), 0, sort_key.key);
+    }
+    if (packet.sprite) {
+      _sorted_sprite_instances.push_back(_sprite_instances[packet.instance]);
+    } else {
+      if (nullptr != instance_slots) {
+        (*instance_slots)[sort_key.index] = static_cast<uint32_t>(_sorted_instances.size());
+      }
+      _sorted_instances.push_back(instances[packet.instance]);
+    }
+    ++batches.back().num_instances;
+    prev_packet = &packet;
+  }
+}
+
+void DrawQueue::sort() {
+  // retained instances lead the instance buffer, so only the transient tail is rebuilt per frame
+  if (!_retained_sorted) {
+    _sorted_instances.clear();
+    _retained_instance_slots.resize(_retained_packets.size());
+    sortPackets(_retained_packets, _retained_instances, _retained_batches,
+                &_retained_instance_slots);
+    _retained_sorted = true;
+  }
+
+  _sorted_instances.resize(_retained_packets.size());
+  _sorted_instances.reserve(_retained_packets.size() + _instances.size());
+  _sorted_sprite_instances.clear();
+  _sorted_sprite_instances.reserve(_sprite_instances.size());
+  sortPackets(_packets, _instances, _transient_batches, nullptr);
+
+  _batches.clear();
+  _batches.reserve(_retained_batches.size() + _transient_batches.size());
+  std::merge(_retained_batches.begin(), _retained_batches.end(), _transient_batches.begin(),
+             _transient_batches.end(), std::back_inserter(_batches),
+             [](const Batch& a, const Batch& b) { return a.key < b.key; });
+}
+
+void DrawQueue::clear() {
+  _packets.clear();
+  _instances.clear();
+  _sprite_instances.clear();
+  _keys.clear();
+  _transient_batches.clear();
+  _batches.clear();
+  _sorted_instances.resize((std::min)(_sorted_instances.size(), _retained_packets.size()));
+  _sorted_sprite_instances.clear();
+
+  _framebuffers.truncate(_retained_slots[0]);
+  _shaders.truncate(_retained_slots[1]);
+  _materials.truncate(_retained_slots[2]);
+  _inputs.truncate(_retained_slots[3]);
+  _meshes.truncate(_retained_slots[4]);
+}
+
+void DrawQueue::clearRetained() {
+  _retained_packets.clear();
+  _retained_instances.clear();
+  _retained_batches.clear();
+  _retained_instance_slots.clear();
+  _retained_slots = {};
+  _retained_sorted = true;
+  clear();
+}
+
+const std::vector<DrawQueue::Batch>& DrawQueue::batches() const {
+  return _batches;
+}
+
+std::span<const CommonPerInstanceData> DrawQueue::instances() const {
+  return _sorted_instances;
+}
+
+std::span<const CommonPerInstanceData> DrawQueue::instances(const Batch& batch) const {
+  return std::span<const CommonPerInstanceData>(_sorted_instances)
+      .subspan(batch.first_instance, batch.num_instances);
+}
+
+std::span<const SpriteInstanceData> DrawQueue::spriteInstances() const {
+  return _sorted_sprite_instances;
+}
+
+std::span<const SpriteInstanceData> DrawQueue::spriteInstances(const Batch& batch) const {
+  return std::span<const SpriteInstanceData>(_sorted_sprite_instances)
+      .subspan(batch.first_instance, batch.num_instances);
+}
+
+const SlotTable<GUID>& DrawQueue::framebuffers() const {
+  return _framebuffers;
+}
+
+const SlotTable<GUID>& DrawQueue::shaders() const {
+  return _shaders;
+}
+
+const SlotTable<GUID>& DrawQueue::materials() const {
+  return _materials;
+}
+
+const ShaderInputsSlotTable& DrawQueue::inputs() const {
+  return _inputs;
+}
+
+const SlotTable<GUID>& DrawQueue::meshes() const {
+  return _meshes;
+}
\ No newline at end of file
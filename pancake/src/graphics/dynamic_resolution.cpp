@@ -0,0 +1,56 @@
+#include "graphics/dynamic_resolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace pancake;
+
+// stepping up has to leave this much of the target spare, so it doesn't step straight back down
+static const double MAX_UPSCALE_LOAD = 0.9;
+
+DynamicResolution::DynamicResolution(double target_milliseconds, float min_scale, float max_scale)
+    : _target_milliseconds(target_milliseconds),
+      _min_scale((std::min)(min_scale, max_scale)),
+      _max_scale(max_scale),
+      _scale(max_scale),
+      _settle_frames(0) {}
+
+float DynamicResolution::update(double gpu_milliseconds) {
+  if ((gpu_milliseconds <= 0.0) || (_target_milliseconds <= 0.0)) {
+    return _scale;
+  }
+  if (0 < _settle_frames) {
+    --_settle_frames;
+    return _scale;
+  }
+
+  float scale = _scale;
+  if (_target_milliseconds < gpu_milliseconds) {
+    // straight to the scale that fits, at least one step down
+    const double fit = _scale * std::sqrt(_target_milliseconds / gpu_milliseconds);
+    scale = (std::min)(static_cast<float>(std::floor(fit / SCALE_STEP) * SCALE_STEP),
+                       _scale - SCALE_STEP);
+  } else {
+    // one step up at a time, if the time it is expected to take still fits
+    const float next = _scale + SCALE_STEP;
+    const double growth = (next * next) / (_scale * _scale);
+    if ((gpu_milliseconds * growth) < (_target_milliseconds * MAX_UPSCALE_LOAD)) {
+      scale = next;
+    }
+  }
+  scale = std::clamp(scale, _min_scale, _max_scale);
+
+  if (scale != _scale) {
+    _scale = scale;
+    _settle_frames = SETTLE_FRAMES;
+  }
+  return _scale;
+}
+
+float DynamicResolution::scale() const {
+  return _scale;
+}
+
+double DynamicResolution::targetMilliseconds() const {
+  return _target_milliseconds;
+}
\ No newline at end of file
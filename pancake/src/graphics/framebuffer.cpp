@@ -40,4 +40,27 @@ void Framebuffer::update(const FramebufferInfo& info) {
   if (update_needed) {
     update();
   }
+}
+
+bool Framebuffer::matches(const FramebufferInfo& info) const {
+  return (_num_targets == info.num_targets) && (_size == info.size) &&
+         (_auto_clear == info.auto_clear) && (_depth_test == info.depth_test) &&
+         (0 == std::memcmp(_render_target_infos, info.render_targets,
+                           info.num_targets * sizeof(RenderTargetInfo)));
+}
+
+void Framebuffer::begin() {
+  if (_auto_clear && _drawn) {
+    preRender();
+  } else {
+    bind();
+  }
+  _drawn = true;
+}
+
+void Framebuffer::clearIfDrawn() {
+  if (_auto_clear && _drawn) {
+    preRender();
+    _drawn = false;
+  }
 }
\ No newline at end of file
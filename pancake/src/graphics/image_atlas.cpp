@@ -6,12 +6,29 @@
 #define STB_RECT_PACK_IMPLEMENTATION
 #include "stb_rect_pack.h"
 
-#include <vector>
-
 using namespace pancake;
 
+// the skyline is kept between updates so new images are placed around the existing ones
+struct ImageAtlas::Packer {
+  stbrp_context context;
+  std::vector<stbrp_node> nodes;
+
+  void reset(int width, int height) {
+    nodes.resize(width);
+    stbrp_init_target(&context, width, height, nodes.data(), static_cast<int>(nodes.size()));
+  }
+};
+
+static bool fitsWithin(const Vec2i& size, const Vec2i& bounds) {
+  return (size.x() <= bounds.x()) && (size.y() <= bounds.y());
+}
+
 ImageAtlas::ImageAtlas(std::string_view path, int width, int height, int channels)
-    : _underlying_image(path, width, height, channels, GUID::null) {}
+    : _underlying_image(path, width, height, channels, GUID::null), _packer(new Packer) {
+  _packer->reset(width, height);
+}
+
+ImageAtlas::~ImageAtlas() = default;
 
 void ImageAtlas::add(const GUID& image_guid) {
   if (!_packed_rects.contains(image_guid)) {
@@ -26,8 +43,9 @@ void ImageAtlas::add(const ImageResource& image) {
 
   if (_packed_rects.contains(guid)) {
     Rect& rect = _packed_rects.at(guid);
-    if (image.size() < rect.size) {
+    if (!_pending_images.contains(guid) && fitsWithin(image.size(), rect.size)) {
       _underlying_image.blit(image, rect.position.x(), rect.position.y());
+      markDirty(rect.position, image.size());
     } else {
       _pending_images.emplace(guid);
     }
@@ -58,6 +76,14 @@ const std::unordered_set<GUID>& ImageAtlas::getRejectedImages() const {
   return _rejected_images;
 }
 
+const std::vector<ImageAtlas::Region>& ImageAtlas::getDirtyRegions() const {
+  return _dirty_regions;
+}
+
+void ImageAtlas::clearDirtyRegions() {
+  _dirty_regions.clear();
+}
+
 void ImageAtlas::update(Resources& resources) {
   _rejected_images.clear();
 
@@ -73,6 +99,50 @@ void ImageAtlas::update(Resources& resources) {
     return;
   }
 
+  // space freed by resized images is only reclaimed once the atlas runs out and is compacted
+  if (!packPending(resources)) {
+    repack(resources);
+  }
+
+  _pending_images.clear();
+}
+
+bool ImageAtlas::packPending(Resources& resources) {
+  std::vector<GUID> guids(_pending_images.begin(), _pending_images.end());
+
+  std::vector<stbrp_rect> s_rects;
+  for (size_t i = 0; i < guids.size(); ++i) {
+    const Rect& rect = _packed_rects.at(guids[i]);
+    stbrp_rect& s_rect = s_rects.emplace_back();
+    s_rect.id = static_cast<int>(i);
+    s_rect.w = rect.size.x();
+    s_rect.h = rect.size.y();
+    s_rect.was_packed = false;
+  }
+
+  if (stbrp_pack_rects(&_packer->context, s_rects.data(), static_cast<int>(s_rects.size())) !=
+      1) {
+    return false;
+  }
+
+  for (const stbrp_rect& s_rect : s_rects) {
+    const GUID& guid = guids[s_rect.id];
+    Rect& rect = _packed_rects.at(guid);
+    rect.position.x() = s_rect.x;
+    rect.position.y() = s_rect.y;
+
+    std::optional<std::reference_wrapper<ImageResource>> img_res =
+        resources.getOrCreate<ImageResource>(guid);
+    if (img_res.has_value()) {
+      _underlying_image.blit(img_res.value(), s_rect.x, s_rect.y);
+    }
+    markDirty(rect.position, rect.size);
+  }
+
+  return true;
+}
+
+void ImageAtlas::repack(Resources& resources) {
   std::vector<GUID> guids;
   for (const auto& [guid, _] : _packed_rects) {
     guids.emplace_back(guid);
@@ -82,18 +152,15 @@ void ImageAtlas::update(Resources& resources) {
   for (size_t i = 0; i < guids.size(); ++i) {
     const Rect& rect = _packed_rects.at(guids[i]);
     stbrp_rect& s_rect = s_rects.emplace_back();
-    s_rect.id = i;
+    s_rect.id = static_cast<int>(i);
     s_rect.w = rect.size.x();
     s_rect.h = rect.size.y();
     s_rect.was_packed = false;
   }
 
-  stbrp_context context;
-  std::vector<struct stbrp_node> nodes(_packed_rects.size());
-  stbrp_init_target(&context, _underlying_image.width(), _underlying_image.height(), nodes.data(),
-                    nodes.size());
-  int result = stbrp_pack_rects(&context, s_rects.data(), static_cast<int>(s_rects.size()));
-  if (result != 1) {
+  _packer->reset(_underlying_image.width(), _underlying_image.height());
+  const int num_rects = static_cast<int>(s_rects.size());
+  if (stbrp_pack_rects(&_packer->context, s_rects.data(), num_rects) != 1) {
     FEWI::warn() << "ImageAtlas " << _underlying_image.path() << " failed to pack all images!";
   }
 
@@ -103,29 +170,37 @@ void ImageAtlas::update(Resources& resources) {
 
   for (const stbrp_rect& s_rect : s_rects) {
     const GUID& guid = guids[s_rect.id];
-    Rect& rect = _packed_rects[guid];
 
-    if (s_rect.was_packed) {
-      if (_pending_images.contains(guid)) {
-        std::optional<std::reference_wrapper<ImageResource>> img_res =
-            resources.getOrCreate<ImageResource>(guid);
-        if (img_res.has_value()) {
-          _underlying_image.blit(img_res.value(), s_rect.x, s_rect.y);
-        }
-      } else {
-        _underlying_image.blit(old, s_rect.x, s_rect.y, rect.position.x(), rect.position.y(),
-                               rect.size.x(), rect.size.y());
-      }
-    } else {
+    if (!s_rect.was_packed) {
       _packed_rects.erase(guid);
       _rejected_images.insert(guid);
+      continue;
+    }
+
+    Rect& rect = _packed_rects.at(guid);
+    if (_pending_images.contains(guid)) {
+      std::optional<std::reference_wrapper<ImageResource>> img_res =
+          resources.getOrCreate<ImageResource>(guid);
+      if (img_res.has_value()) {
+        _underlying_image.blit(img_res.value(), s_rect.x, s_rect.y);
+      }
+    } else {
+      _underlying_image.blit(old, s_rect.x, s_rect.y, rect.position.x(), rect.position.y(),
+                             rect.size.x(), rect.size.y());
     }
 
     rect.position.x() = s_rect.x;
     rect.position.y() = s_rect.y;
   }
 
-  _pending_images.clear();
+  _dirty_regions.clear();
+  markDirty(Vec2i::zeros(), _underlying_image.size());
+}
+
+void ImageAtlas::markDirty(const Vec2i& position, const Vec2i& size) {
+  if ((0 < size.x()) && (0 < size.y())) {
+    _dirty_regions.emplace_back(position, size);
+  }
 }
 
 ImageResource& ImageAtlas::image() {
@@ -6,12 +6,12 @@
 using namespace pancake;
 
 LightInfo::LightInfo(const Transform3D& transform, const PointLight& point_light)
-    : position(transform.translation()), color(point_light.color) {}
+    : position(transform.translation()), color(point_light.color), radius(point_light.radius) {}
 
 bool LightInfo::operator<(const LightInfo& rhs) const {
-  return std::tie(position, color) < std::tie(rhs.position, rhs.color);
+  return std::tie(position, color, radius) < std::tie(rhs.position, rhs.color, rhs.radius);
 }
 
 bool LightInfo::operator==(const LightInfo& rhs) const {
-  return std::tie(position, color) == std::tie(rhs.position, rhs.color);
+  return std::tie(position, color, radius) == std::tie(rhs.position, rhs.color, rhs.radius);
 }
\ No newline at end of file
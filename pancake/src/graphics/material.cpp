@@ -1,5 +1,9 @@
 #include "graphics/material.hpp"
 
+#include "graphics/shader.hpp"
+
+#include <algorithm>
+
 using namespace pancake;
 
 Material::Material(const GUID& guid) : _guid(guid) {
@@ -10,10 +14,30 @@ template <>
 void Material::resourceUpdated<MaterialOrigin>(const MaterialResource& res) {
   _shader = res.getShader();
   _depth_test = res.getDepthTest();
+  _opaque = res.getOpaque();
   _stage = res.getStage();
   _light_pass_input_name = res.getLightPassInputName();
   _view_input_name = res.getViewInputName();
   _inputs = res.getInputs();
+
+  _texture_inputs.clear();
+  _uniform_inputs.clear();
+  for (const ShaderInput& input : _inputs) {
+    if (ShaderInput::Type::TextureRef == input.getType()) {
+      _texture_inputs.push_back(input);
+    } else {
+      _uniform_inputs.push_back(input);
+    }
+  }
+
+  _view_position_uniform.reset();
+  _view_transform_uniform.reset();
+  if (!_view_input_name.empty()) {
+    _view_position_uniform.emplace(_view_input_name + "_position");
+    _view_transform_uniform.emplace(_view_input_name + "_transform");
+  }
+
+  _uniform_buffer_outdated = true;
 }
 
 void Material::resourcesUpdated() {}
@@ -26,6 +50,10 @@ bool Material::getDepthTest() const {
   return _depth_test;
 }
 
+bool Material::getOpaque() const {
+  return _opaque;
+}
+
 int Material::getStage() const {
   return _stage;
 }
@@ -42,6 +70,57 @@ const std::set<ShaderInput>& Material::getInputs() const {
   return _inputs;
 }
 
+const std::vector<ShaderInput>& Material::getTextureInputs() const {
+  return _texture_inputs;
+}
+
+const std::vector<ShaderInput>& Material::getUniformInputs() const {
+  return _uniform_inputs;
+}
+
+const std::optional<UniformId>& Material::getViewPositionUniform() const {
+  return _view_position_uniform;
+}
+
+const std::optional<UniformId>& Material::getViewTransformUniform() const {
+  return _view_transform_uniform;
+}
+
+void Material::setUniformBuffer(std::unique_ptr<UniformBuffer> uniform_buffer) {
+  _uniform_buffer = std::move(uniform_buffer);
+  _uniform_buffer_outdated = true;
+}
+
+const UniformBuffer* Material::getUniformBuffer() const {
+  return _uniform_buffer.get();
+}
+
+void Material::updateUniformBuffer(const Shader& shader) {
+  const UniformBlockLayout* layout = shader.getUniformBlockLayout(UniformBlock::Material);
+  if ((nullptr == _uniform_buffer) || (nullptr == layout)) {
+    return;
+  }
+
+  if (!_uniform_buffer_outdated && (_uniform_buffer_shader == shader.guid()) &&
+      (_uniform_buffer_shader_gen == shader.gen())) {
+    return;
+  }
+
+  std::vector<std::byte> data(layout->size, std::byte(0));
+  for (const ShaderInput& input : _uniform_inputs) {
+    const auto it = std::ranges::find_if(
+        layout->offsets, [&input](const auto& member) { return member.first == input.getId(); });
+    if ((it != layout->offsets.end()) && (it->second < data.size())) {
+      input.writeStd140(std::span(data).subspan(it->second));
+    }
+  }
+  _uniform_buffer->update(data);
+
+  _uniform_buffer_outdated = false;
+  _uniform_buffer_shader = shader.guid();
+  _uniform_buffer_shader_gen = shader.gen();
+}
+
 const GUID& Material::guid() const {
   return _guid;
 }
\ No newline at end of file
@@ -1,18 +1,89 @@
 #include "graphics/mesh.hpp"
 
+#include <algorithm>
+#include <limits>
+
 using namespace pancake;
 
-Mesh::Mesh(const GUID& guid) : _guid(guid) {
+Mesh::Mesh(const GUID& guid)
+    : _lods(),
+      _guid(guid),
+      _bounds_min(Vec3f::zeros()),
+      _bounds_max(Vec3f::zeros()),
+      _occluder_positions(),
+      _occluder_indices() {
   setResourceGuid<MeshResourceInterface, MeshRes>(_guid);
 }
 
 template <>
 void Mesh::resourceUpdated<MeshRes>(const MeshResourceInterface& res) {
-  update(res.getVertices(), res.getIndices());
+  update(res.getVertices(), res.getIndices(), res.getVertexLayout(), res.getLodIndices(),
+         res.getLods());
 }
 
 void Mesh::resourcesUpdated() {}
 
 const GUID& Mesh::guid() const {
   return _guid;
+}
+
+std::span<const MeshLod> Mesh::lods() const {
+  return _lods;
+}
+
+const Vec3f& Mesh::boundsMin() const {
+  return _bounds_min;
+}
+
+const Vec3f& Mesh::boundsMax() const {
+  return _bounds_max;
+}
+
+std::span<const Vec3f> Mesh::occluderPositions() const {
+  return _occluder_positions;
+}
+
+std::span<const unsigned int> Mesh::occluderIndices() const {
+  return _occluder_indices;
+}
+
+void Mesh::updateShape(std::span<const Vertex> vertices,
+                       std::span<const unsigned int> indices,
+                       std::span<const MeshLod> lods) {
+  _lods.assign(lods.begin(), lods.end());
+
+  _bounds_min = Vec3f::zeros();
+  _bounds_max = Vec3f::zeros();
+  if (!vertices.empty()) {
+    _bounds_min = Vec3f(std::numeric_limits<float>::max());
+    _bounds_max = Vec3f(std::numeric_limits<float>::lowest());
+    for (const Vertex& vertex : vertices) {
+      const Vec3f position(vertex.position.x(), vertex.position.y(), vertex.position.z());
+      _bounds_min = _bounds_min.min(position);
+      _bounds_max = _bounds_max.max(position);
+    }
+  }
+
+  // simplified levels can stray outside the surface and hide what should be seen, so only full
+  // detail occludes. only the vertices it uses are kept
+  _occluder_positions.clear();
+  _occluder_indices.clear();
+  if ((indices.size() / 3) <= MAX_OCCLUDER_TRIANGLES) {
+    std::vector<unsigned int> remap(vertices.size(), ~0u);
+    for (size_t i = 0; (i + 2) < indices.size(); i += 3) {
+      if (std::any_of(&indices[i], &indices[i] + 3,
+                      [&](unsigned int index) { return vertices.size() <= index; })) {
+        continue;
+      }
+      for (size_t c = 0; c < 3; ++c) {
+        unsigned int& slot = remap[indices[i + c]];
+        if (~0u == slot) {
+          const Vec4f& position = vertices[indices[i + c]].position;
+          slot = static_cast<unsigned int>(_occluder_positions.size());
+          _occluder_positions.emplace_back(position.x(), position.y(), position.z());
+        }
+        _occluder_indices.push_back(slot);
+      }
+    }
+  }
 }
\ No newline at end of file
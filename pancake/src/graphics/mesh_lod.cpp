@@ -0,0 +1,324 @@
+#include "graphics/mesh_lod.hpp"
+
+#include "graphics/mesh_optimiser.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <utility>
+
+using namespace pancake;
+
+// meshes this small aren't worth simplifying
+static const size_t MIN_LOD_TRIANGLES = 32;
+
+// a level has to drop at least a quarter of the previous level's triangles to be kept
+static const double MIN_LOD_REDUCTION = 0.75;
+
+// collapses straying further than this fraction of the mesh's extent are never made
+static const double MAX_RELATIVE_ERROR = 0.05;
+
+using Position = std::array<double, 3>;
+
+static Position sub(const Position& a, const Position& b) {
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+static Position cross(const Position& a, const Position& b) {
+  return {(a[1] * b[2]) - (a[2] * b[1]), (a[2] * b[0]) - (a[0] * b[2]),
+          (a[0] * b[1]) - (a[1] * b[0])};
+}
+
+static double dot(const Position& a, const Position& b) {
+  return (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]);
+}
+
+// symmetric 4x4 matrix summing squared distances to a set of planes
+struct Quadric {
+  double aa = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+  double bb = 0.0, bc = 0.0, bd = 0.0;
+  double cc = 0.0, cd = 0.0;
+  double dd = 0.0;
+
+  static Quadric plane(const Position& normal, double d) {
+    const double a = normal[0];
+    const double b = normal[1];
+    const double c = normal[2];
+    return {a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d};
+  }
+
+  Quadric& operator+=(const Quadric& rhs) {
+    aa += rhs.aa;
+    ab += rhs.ab;
+    ac += rhs.ac;
+    ad += rhs.ad;
+    bb += rhs.bb;
+    bc += rhs.bc;
+    bd += rhs.bd;
+    cc += rhs.cc;
+    cd += rhs.cd;
+    dd += rhs.dd;
+    return *this;
+  }
+
+  double error(const Position& p) const {
+    const double x = p[0];
+    const double y = p[1];
+    const double z = p[2];
+    const double error = (aa * x * x) + (2.0 * ab * x * y) + (2.0 * ac * x * z) + (2.0 * ad * x) +
+                         (bb * y * y) + (2.0 * bc * y * z) + (2.0 * bd * y) + (cc * z * z) +
+                         (2.0 * cd * z) + dd;
+    return (std::max)(error, 0.0);
+  }
+};
+
+struct Collapse {
+  double cost;
+  unsigned int from;
+  unsigned int to;
+};
+
+// vertices sharing a position are welded for quadrics and borders. a vertex may only collapse if
+// it alone sits at its position and that position isn't on a border, so seams and holes keep
+// their shape
+struct Simplifier {
+  std::vector<uint32_t> position_ids;
+  std::vector<Position> positions;
+  std::vector<Quadric> quadrics;
+  std::vector<bool> locked;
+  double max_cost = 0.0;
+  double cost = 0.0;
+
+  Simplifier(std::span<const Vertex> vertices, std::span<const unsigned int> indices);
+
+  bool flips(std::span<const unsigned int> indices,
+             std::span<const unsigned int> triangles,
+             unsigned int from,
+             unsigned int to) const;
+  size_t collapse(std::vector<unsigned int>& indices, size_t target_indices);
+};
+
+Simplifier::Simplifier(std::span<const Vertex> vertices, std::span<const unsigned int> indices)
+    : position_ids(vertices.size()), positions(), quadrics(), locked(vertices.size(), false) {
+  std::vector<uint32_t> position_vertices;
+  {
+    std::map<std::array<float, 3>, uint32_t> lookup;
+    for (size_t v = 0; v < vertices.size(); ++v) {
+      const Vec4f& p = vertices[v].position;
+      const auto [it, inserted] =
+          lookup.try_emplace({p.x(), p.y(), p.z()}, static_cast<uint32_t>(positions.size()));
+      if (inserted) {
+        positions.push_back({p.x(), p.y(), p.z()});
+        position_vertices.push_back(0);
+      }
+      position_ids[v] = it->second;
+      ++position_vertices[it->second];
+    }
+  }
+
+  Position min = positions.front();
+  Position max = positions.front();
+  for (const Position& p : positions) {
+    for (size_t c = 0; c < 3; ++c) {
+      min[c] = (std::min)(min[c], p[c]);
+      max[c] = (std::max)(max[c], p[c]);
+    }
+  }
+  const Position extent = sub(max, min);
+  max_cost = dot(extent, extent) * MAX_RELATIVE_ERROR * MAX_RELATIVE_ERROR;
+
+  quadrics.resize(positions.size());
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> edge_triangles;
+  for (size_t t = 0; (t + 2) < indices.size(); t += 3) {
+    const uint32_t ids[3] = {position_ids[indices[t]], position_ids[indices[t + 1]],
+                             position_ids[indices[t + 2]]};
+
+    Position normal = cross(sub(positions[ids[1]], positions[ids[0]]),
+                            sub(positions[ids[2]], positions[ids[0]]));
+    if (const double length = std::sqrt(dot(normal, normal)); 0.0 < length) {
+      normal = {normal[0] / length, normal[1] / length, normal[2] / length};
+      const Quadric plane = Quadric::plane(normal, -dot(normal, positions[ids[0]]));
+      for (const uint32_t id : ids) {
+        quadrics[id] += plane;
+      }
+    }
+
+    for (size_t c = 0; c < 3; ++c) {
+      const uint32_t a = ids[c];
+      const uint32_t b = ids[(c + 1) % 3];
+      ++edge_triangles[{(std::min)(a, b), (std::max)(a, b)}];
+    }
+  }
+
+  std::vector<bool> border(positions.size(), false);
+  for (const auto& [edge, num_triangles] : edge_triangles) {
+    if (2 != num_triangles) {
+      border[edge.first] = true;
+      border[edge.second] = true;
+    }
+  }
+
+  for (size_t v = 0; v < vertices.size(); ++v) {
+    const uint32_t id = position_ids[v];
+    locked[v] = border[id] || (1 < position_vertices[id]);
+  }
+}
+
+bool Simplifier::flips(std::span<const unsigned int> indices,
+                       std::span<const unsigned int> triangles,
+                       unsigned int from,
+                       unsigned int to) const {
+  for (const unsigned int t : triangles) {
+    const unsigned int* triangle = &indices[t * 3];
+    if (std::any_of(triangle, triangle + 3, [&](unsigned int v) {
+          return position_ids[v] == position_ids[to];
+        })) {
+      continue;
+    }
+
+    Position corners[3];
+    Position moved[3];
+    for (size_t c = 0; c < 3; ++c) {
+      corners[c] = positions[position_ids[triangle[c]]];
+      moved[c] = (triangle[c] == from) ? positions[position_ids[to]] : corners[c];
+    }
+
+    const Position before = cross(sub(corners[1], corners[0]), sub(corners[2], corners[0]));
+    const Position after = cross(sub(moved[1], moved[0]), sub(moved[2], moved[0]));
+    if (dot(before, after) <= 0.0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t Simplifier::collapse(std::vector<unsigned int>& indices, size_t target_indices) {
+  const size_t num_vertices = position_ids.size();
+  const size_t num_triangles = indices.size() / 3;
+
+  std::vector<unsigned int> adjacency_offsets(num_vertices + 1, 0);
+  for (const unsigned int index : indices) {
+    ++adjacency_offsets[index + 1];
+  }
+  for (size_t v = 0; v < num_vertices; ++v) {
+    adjacency_offsets[v + 1] += adjacency_offsets[v];
+  }
+  std::vector<unsigned int> adjacency(adjacency_offsets.back());
+  std::vector<unsigned int> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+  for (unsigned int t = 0; t < num_triangles; ++t) {
+    for (size_t c = 0; c < 3; ++c) {
+      adjacency[fill[indices[(t * 3) + c]]++] = t;
+    }
+  }
+  const auto triangles = [&](unsigned int v) {
+    return std::span<const unsigned int>(adjacency)
+        .subspan(adjacency_offsets[v], adjacency_offsets[v + 1] - adjacency_offsets[v]);
+  };
+
+  std::vector<Collapse> collapses;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const unsigned int a = indices[i];
+    const unsigned int b = indices[(i % 3 == 2) ? (i - 2) : (i + 1)];
+    for (const auto& [from, to] : {std::pair(a, b), std::pair(b, a)}) {
+      if (locked[from] || (position_ids[from] == position_ids[to])) {
+        continue;
+      }
+
+      Quadric quadric = quadrics[position_ids[from]];
+      quadric += quadrics[position_ids[to]];
+      if (const double cost = quadric.error(positions[position_ids[to]]); cost <= max_cost) {
+        collapses.emplace_back(cost, from, to);
+      }
+    }
+  }
+  std::sort(collapses.begin(), collapses.end(),
+            [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+  // each collapse removes around two triangles. anything touching a collapsed triangle waits for
+  // the next pass, so every flip test here sees the geometry as it will be
+  const size_t max_collapses = (std::max)(size_t(1), (indices.size() - target_indices) / 6);
+  std::vector<bool> touched(positions.size(), false);
+  std::vector<unsigned int> remap(num_vertices);
+  for (unsigned int v = 0; v < num_vertices; ++v) {
+    remap[v] = v;
+  }
+
+  size_t num_collapses = 0;
+  for (const Collapse& collapse : collapses) {
+    if (max_collapses <= num_collapses) {
+      break;
+    }
+    if (touched[position_ids[collapse.from]] || touched[position_ids[collapse.to]] ||
+        flips(indices, triangles(collapse.from), collapse.from, collapse.to)) {
+      continue;
+    }
+
+    remap[collapse.from] = collapse.to;
+    quadrics[position_ids[collapse.to]] += quadrics[position_ids[collapse.from]];
+    cost = (std::max)(cost, collapse.cost);
+    for (const unsigned int t : triangles(collapse.from)) {
+      for (size_t c = 0; c < 3; ++c) {
+        touched[position_ids[indices[(t * 3) + c]]] = true;
+      }
+    }
+    ++num_collapses;
+  }
+
+  size_t kept = 0;
+  for (size_t t = 0; t < num_triangles; ++t) {
+    const unsigned int a = remap[indices[t * 3]];
+    const unsigned int b = remap[indices[(t * 3) + 1]];
+    const unsigned int c = remap[indices[(t * 3) + 2]];
+    if ((position_ids[a] != position_ids[b]) && (position_ids[b] != position_ids[c]) &&
+        (position_ids[c] != position_ids[a])) {
+      indices[kept++] = a;
+      indices[kept++] = b;
+      indices[kept++] = c;
+    }
+  }
+  indices.resize(kept);
+
+  return num_collapses;
+}
+
+void pancake::buildMeshLods(std::span<const Vertex> vertices,
+                            std::span<const unsigned int> indices,
+                            std::vector<unsigned int>& lod_indices,
+                            std::vector<MeshLod>& lods) {
+  if (((indices.size() / 3) < MIN_LOD_TRIANGLES) ||
+      std::any_of(indices.begin(), indices.end(),
+                  [&](unsigned int index) { return vertices.size() <= index; })) {
+    return;
+  }
+
+  Simplifier simplifier(vertices, indices);
+  std::vector<unsigned int> current(indices.begin(), indices.begin() + ((indices.size() / 3) * 3));
+
+  while ((lods.size() + 1) < MAX_MESH_LODS) {
+    const size_t prev_size = current.size();
+    const size_t target_size = (prev_size / 6) * 3;
+    while ((target_size < current.size()) && (0 < simplifier.collapse(current, target_size))) {
+    }
+
+    if ((prev_size * MIN_LOD_REDUCTION) < current.size()) {
+      break;
+    }
+
+    const size_t first_index = lod_indices.size();
+    lod_indices.insert(lod_indices.end(), current.begin(), current.end());
+    optimiseVertexCache(std::span(lod_indices).subspan(first_index), vertices.size());
+    lods.emplace_back(static_cast<uint32_t>(first_index), static_cast<uint32_t>(current.size()),
+                      static_cast<float>(std::sqrt(simplifier.cost)));
+  }
+}
+
+uint32_t pancake::selectMeshLod(std::span<const MeshLod> lods,
+                                float pixels_per_unit,
+                                float max_pixel_error) {
+  uint32_t lod = 0;
+  while ((lod < lods.size()) && ((lods[lod].error * pixels_per_unit) <= max_pixel_error)) {
+    ++lod;
+  }
+  return lod;
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "graphics/mesh_optimiser.hpp"
+
+#include "util/fewi.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace pancake;
+
+static const size_t CACHE_SIZE = 32;
+static const unsigned int NO_INDEX = std::numeric_limits<unsigned int>::max();
+
+// favours the last triangle's vertices, then recently used ones, then vertices with few
+// triangles left so lone triangles aren't stranded
+static float vertexScore(int cache_position, unsigned int live_triangles) {
+  if (0 == live_triangles) {
+    return -1.f;
+  }
+
+  float score = 0.f;
+  if ((0 <= cache_position) && (cache_position < 3)) {
+    score = 0.75f;
+  } else if (3 <= cache_position) {
+    const float scale = 1.f / (CACHE_SIZE - 3);
+    score = std::pow(1.f - ((cache_position - 3) * scale), 1.5f);
+  }
+
+  return score + (2.f / std::sqrt(static_cast<float>(live_triangles)));
+}
+
+void pancake::optimiseVertexCache(std::span<unsigned int> indices, size_t num_vertices) {
+  const size_t num_triangles = indices.size() / 3;
+  if (num_triangles < 2) {
+    return;
+  }
+
+  // vertex to triangle adjacency, live_triangles doubles as each vertex's remaining range size
+  std::vector<unsigned int> live_triangles(num_vertices, 0);
+  for (const unsigned int index : indices.first(num_triangles * 3)) {
+    if (num_vertices <= index) {
+      FEWI::warn() << "Index " << index << " out of range, skipping vertex cache optimisation";
+      return;
+    }
+    ++live_triangles[index];
+  }
+
+  std::vector<unsigned int> adjacency_offsets(num_vertices + 1, 0);
+  for (size_t v = 0; v < num_vertices; ++v) {
+    adjacency_offsets[v + 1] = adjacency_offsets[v] + live_triangles[v];
+  }
+
+  std::vector<unsigned int> adjacency(adjacency_offsets.back());
+  std::vector<unsigned int> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+  for (unsigned int t = 0; t < num_triangles; ++t) {
+    for (size_t c = 0; c < 3; ++c) {
+      adjacency[fill[indices[(t * 3) + c]]++] = t;
+    }
+  }
+
+  std::vector<int> cache_positions(num_vertices, -1);
+  std::vector<float> vertex_scores(num_vertices);
+  for (size_t v = 0; v < num_vertices; ++v) {
+    vertex_scores[v] = vertexScore(-1, live_triangles[v]);
+  }
+
+  std::vector<float> triangle_scores(num_triangles);
+  std::vector<bool> emitted(num_triangles, false);
+  for (size_t t = 0; t < num_triangles; ++t) {
+    triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[(t * 3) + 1]] +
+                         vertex_scores[indices[(t * 3) + 2]];
+  }
+
+  std::vector<unsigned int> output;
+  output.reserve(num_triangles * 3);
+
+  std::vector<unsigned int> cache;
+  std::vector<unsigned int> next_cache;
+  cache.reserve(CACHE_SIZE + 3);
+  next_cache.reserve(CACHE_SIZE + 3);
+
+  const auto first_best = std::max_element(triangle_scores.begin(), triangle_scores.end());
+  unsigned int best_triangle =
+      static_cast<unsigned int>(std::distance(triangle_scores.begin(), first_best));
+  size_t scan_cursor = 0;
+
+  while (NO_INDEX != best_triangle) {
+    const unsigned int* triangle = &indices[best_triangle * 3];
+    emitted[best_triangle] = true;
+    output.insert(output.end(), triangle, triangle + 3);
+
+    // the emitted triangle's vertices move to the front of the cache
+    next_cache.assign(triangle, triangle + 3);
+    for (const unsigned int v : cache) {
+      if ((v != triangle[0]) && (v != triangle[1]) && (v != triangle[2])) {
+        next_cache.push_back(v);
+      }
+    }
+
+    for (size_t c = 0; c < 3; ++c) {
+      const unsigned int v = triangle[c];
+      unsigned int* begin = &adjacency[adjacency_offsets[v]];
+      unsigned int* end = begin + live_triangles[v];
+      std::iter_swap(std::find(begin, end, best_triangle), end - 1);
+      --live_triangles[v];
+    }
+
+    for (size_t i = 0; i < next_cache.size(); ++i) {
+      const unsigned int v = next_cache[i];
+      cache_positions[v] = (i < CACHE_SIZE) ? static_cast<int>(i) : -1;
+      vertex_scores[v] = vertexScore(cache_positions[v], live_triangles[v]);
+    }
+    if (CACHE_SIZE < next_cache.size()) {
+      next_cache.resize(CACHE_SIZE);
+    }
+    cache.swap(next_cache);
+
+    // only triangles touching the cache changed score, the best is usually among them
+    best_triangle = NO_INDEX;
+    float best_score = -1.f;
+    for (const unsigned int v : cache) {
+      const unsigned int* begin = &adjacency[adjacency_offsets[v]];
+      for (const unsigned int* it = begin; it != begin + live_triangles[v]; ++it) {
+        const unsigned int t = *it;
+        triangle_scores[t] = vertex_scores[indices[t * 3]] +
+                             vertex_scores[indices[(t * 3) + 1]] +
+                             vertex_scores[indices[(t * 3) + 2]];
+        if (best_score < triangle_scores[t]) {
+          best_score = triangle_scores[t];
+          best_triangle = t;
+        }
+      }
+    }
+
+    if (NO_INDEX == best_triangle) {
+      while ((scan_cursor < num_triangles) && emitted[scan_cursor]) {
+        ++scan_cursor;
+      }
+      if (scan_cursor < num_triangles) {
+        best_triangle = static_cast<unsigned int>(scan_cursor);
+      }
+    }
+  }
+
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void pancake::optimiseVertexFetch(std::vector<Vertex>& vertices, std::span<unsigned int> indices) {
+  std::vector<unsigned int> remap(vertices.size(), NO_INDEX);
+  std::vector<Vertex> reordered;
+  reordered.reserve(vertices.size());
+
+  for (const unsigned int index : indices) {
+    if (vertices.size() <= index) {
+      FEWI::warn() << "Index " << index << " out of range, skipping vertex fetch optimisation";
+      return;
+    }
+  }
+
+  for (unsigned int& index : indices) {
+    if (NO_INDEX == remap[index]) {
+      remap[index] = static_cast<unsigned int>(reordered.size());
+      reordered.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  vertices.swap(reordered);
+}
+
+void pancake::optimiseMesh(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+  optimiseVertexCache(indices, vertices.size());
+  optimiseVertexFetch(vertices, indices);
+}
\ No newline at end of file
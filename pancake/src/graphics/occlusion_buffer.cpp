@@ -0,0 +1,241 @@
+#include "graphics/occlusion_buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+using namespace pancake;
+
+static const float FAR_DEPTH = std::numeric_limits<float>::max();
+
+// pyramid level whose texels are tested once a footprint spans fewer than this many of them
+static const int MAX_TEST_TEXELS = 4;
+
+struct Clip {
+  float x, y, z, w;
+
+  bool beforeNear() const { return (z < -w) || (w <= 0.f); }
+};
+
+static Clip transform(const Mat4f& mvp, const Vec3f& p) {
+  const float x = p.x();
+  const float y = p.y();
+  const float z = p.z();
+  return {(mvp[0][0] * x) + (mvp[1][0] * y) + (mvp[2][0] * z) + mvp[3][0],
+          (mvp[0][1] * x) + (mvp[1][1] * y) + (mvp[2][1] * z) + mvp[3][1],
+          (mvp[0][2] * x) + (mvp[1][2] * y) + (mvp[2][2] * z) + mvp[3][2],
+          (mvp[0][3] * x) + (mvp[1][3] * y) + (mvp[2][3] * z) + mvp[3][3]};
+}
+
+void OcclusionBuffer::clear(const Vec2i& framebuffer_size) {
+  const int width = (std::max)(framebuffer_size.x(), 1);
+  const int height = (std::max)(framebuffer_size.y(), 1);
+  const Vec2i size = (height <= width)
+                         ? Vec2i(MAX_SIZE, (std::max)((MAX_SIZE * height) / width, 1))
+                         : Vec2i((std::max)((MAX_SIZE * width) / height, 1), MAX_SIZE);
+
+  if (_sizes.empty() || (_sizes.front() != size)) {
+    _sizes.assign(1, size);
+    while ((1 < _sizes.back().x()) || (1 < _sizes.back().y())) {
+      _sizes.push_back(Vec2i((_sizes.back().x() + 1) / 2, (_sizes.back().y() + 1) / 2));
+    }
+    _levels.resize(_sizes.size());
+    for (size_t level = 0; level < _sizes.size(); ++level) {
+      _levels[level].resize(_sizes[level].x() * _sizes[level].y());
+    }
+  }
+
+  std::fill(_levels.front().begin(), _levels.front().end(), FAR_DEPTH);
+  _empty = true;
+}
+
+void OcclusionBuffer::rasterise(std::span<const Vec3f> positions,
+                                std::span<const unsigned int> indices,
+                                const Mat4f& mvp) {
+  const int width = _sizes.front().x();
+  const int height = _sizes.front().y();
+  std::vector<float>& depths = _levels.front();
+
+  for (size_t t = 0; (t + 2) < indices.size(); t += 3) {
+    float sx[3];
+    float sy[3];
+    float sz[3];
+    bool skip = false;
+    for (size_t c = 0; c < 3; ++c) {
+      const Clip clip = transform(mvp, positions[indices[t + c]]);
+      if (clip.beforeNear()) {
+        skip = true;
+        break;
+      }
+      const float inv_w = 1.f / clip.w;
+      sx[c] = ((clip.x * inv_w * 0.5f) + 0.5f) * width;
+      sy[c] = ((clip.y * inv_w * 0.5f) + 0.5f) * height;
+      sz[c] = clip.z * inv_w;
+    }
+    if (skip) {
+      continue;
+    }
+
+    // either winding occludes, so clockwise triangles are flipped
+    float area = ((sx[1] - sx[0]) * (sy[2] - sy[0])) - ((sx[2] - sx[0]) * (sy[1] - sy[0]));
+    if (area < 0.f) {
+      std::swap(sx[1], sx[2]);
+      std::swap(sy[1], sy[2]);
+      std::swap(sz[1], sz[2]);
+      area = -area;
+    }
+    if (area <= std::numeric_limits<float>::epsilon()) {
+      continue;
+    }
+
+    const float left = (std::min)({sx[0], sx[1], sx[2]});
+    const float right = (std::max)({sx[0], sx[1], sx[2]});
+    const float bottom = (std::min)({sy[0], sy[1], sy[2]});
+    const float top = (std::max)({sy[0], sy[1], sy[2]});
+    const int min_x = (std::max)(static_cast<int>(std::floor(left)), 0);
+    const int max_x = (std::min)(static_cast<int>(std::ceil(right)), width);
+    const int min_y = (std::max)(static_cast<int>(std::floor(bottom)), 0);
+    const int max_y = (std::min)(static_cast<int>(std::ceil(top)), height);
+
+    // edge functions, each weighting the vertex opposite its edge, positive inside
+    const float inv_area = 1.f / area;
+    float a[3];
+    float b[3];
+    float e[3];
+    for (size_t c = 0; c < 3; ++c) {
+      const size_t from = (c + 1) % 3;
+      const size_t to = (c + 2) % 3;
+      a[c] = sy[from] - sy[to];
+      b[c] = sx[to] - sx[from];
+      e[c] = -((a[c] * sx[from]) + (b[c] * sy[from]));
+    }
+
+    // branchless rows, so the compiler is free to vectorise them
+    for (int y = min_y; y < max_y; ++y) {
+      const float py = y + 0.5f;
+      const float row0 = (b[0] * py) + e[0];
+      const float row1 = (b[1] * py) + e[1];
+      const float row2 = (b[2] * py) + e[2];
+      float* row = depths.data() + (y * width);
+      for (int x = min_x; x < max_x; ++x) {
+        const float px = x + 0.5f;
+        const float w0 = (a[0] * px) + row0;
+        const float w1 = (a[1] * px) + row1;
+        const float w2 = (a[2] * px) + row2;
+        const float depth = ((w0 * sz[0]) + (w1 * sz[1]) + (w2 * sz[2])) * inv_area;
+        const bool inside = (0.f <= w0) && (0.f <= w1) && (0.f <= w2);
+        row[x] = (inside && (depth < row[x])) ? depth : row[x];
+      }
+    }
+    _empty = false;
+  }
+}
+
+void OcclusionBuffer::finish() {
+  for (size_t level = 1; level < _levels.size(); ++level) {
+    const Vec2i& src_size = _sizes[level - 1];
+    const Vec2i& dst_size = _sizes[level];
+    const std::vector<float>& src = _levels[level - 1];
+    std::vector<float>& dst = _levels[level];
+
+    for (int y = 0; y < dst_size.y(); ++y) {
+      const int y0 = y * 2;
+      const int y1 = (std::min)(y0 + 1, src_size.y() - 1);
+      for (int x = 0; x < dst_size.x(); ++x) {
+        const int x0 = x * 2;
+        const int x1 = (std::min)(x0 + 1, src_size.x() - 1);
+        dst[(y * dst_size.x()) + x] =
+            (std::max)({src[(y0 * src_size.x()) + x0], src[(y0 * src_size.x()) + x1],
+                        src[(y1 * src_size.x()) + x0], src[(y1 * src_size.x()) + x1]});
+      }
+    }
+  }
+}
+
+float OcclusionBuffer::coverage(const Vec3f& min, const Vec3f& max, const Mat4f& mvp) const {
+  Footprint footprint;
+  if (!project(min, max, mvp, footprint)) {
+    return 0.f;
+  }
+  if (footprint.clipped) {
+    return 1.f;
+  }
+
+  const Vec2i& size = _sizes.front();
+  const float width = (std::min)(footprint.max_x, static_cast<float>(size.x())) -
+                      (std::max)(footprint.min_x, 0.f);
+  const float height = (std::min)(footprint.max_y, static_cast<float>(size.y())) -
+                       (std::max)(footprint.min_y, 0.f);
+  return (std::max)(width, 0.f) * (std::max)(height, 0.f) / (size.x() * size.y());
+}
+
+bool OcclusionBuffer::visible(const Vec3f& min, const Vec3f& max, const Mat4f& mvp) const {
+  Footprint footprint;
+  if (!project(min, max, mvp, footprint)) {
+    return false;
+  }
+  if (footprint.clipped || _empty) {
+    return true;
+  }
+
+  // inclusive texel ranges, halving them keeps every covered texel covered
+  const Vec2i& size = _sizes.front();
+  int x0 = std::clamp(static_cast<int>(std::floor(footprint.min_x)), 0, size.x() - 1);
+  int y0 = std::clamp(static_cast<int>(std::floor(footprint.min_y)), 0, size.y() - 1);
+  int x1 = std::clamp(static_cast<int>(std::ceil(footprint.max_x)) - 1, x0, size.x() - 1);
+  int y1 = std::clamp(static_cast<int>(std::ceil(footprint.max_y)) - 1, y0, size.y() - 1);
+  size_t level = 0;
+  while (((level + 1) < _levels.size()) &&
+         ((MAX_TEST_TEXELS <= (x1 - x0)) || (MAX_TEST_TEXELS <= (y1 - y0)))) {
+    x0 /= 2;
+    y0 /= 2;
+    x1 /= 2;
+    y1 /= 2;
+    ++level;
+  }
+
+  const int width = _sizes[level].x();
+  const std::vector<float>& depths = _levels[level];
+  for (int y = y0; y <= y1; ++y) {
+    for (int x = x0; x <= x1; ++x) {
+      if (footprint.depth <= depths[(y * width) + x]) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool OcclusionBuffer::project(const Vec3f& min,
+                              const Vec3f& max,
+                              const Mat4f& mvp,
+                              Footprint& footprint) const {
+  footprint = {FAR_DEPTH, FAR_DEPTH, -FAR_DEPTH, -FAR_DEPTH, FAR_DEPTH, false};
+
+  // a plane with every corner outside it puts the whole box outside the frustum
+  unsigned int outside = 0x3F;
+  for (unsigned int i = 0; i < 8; ++i) {
+    const Vec3f corner((i & 1) ? max.x() : min.x(), (i & 2) ? max.y() : min.y(),
+                       (i & 4) ? max.z() : min.z());
+    const Clip clip = transform(mvp, corner);
+    outside &= ((clip.x < -clip.w) ? 0x01 : 0) | ((clip.w < clip.x) ? 0x02 : 0) |
+               ((clip.y < -clip.w) ? 0x04 : 0) | ((clip.w < clip.y) ? 0x08 : 0) |
+               ((clip.z < -clip.w) ? 0x10 : 0) | ((clip.w < clip.z) ? 0x20 : 0);
+
+    if (clip.beforeNear()) {
+      footprint.clipped = true;
+      continue;
+    }
+    const float inv_w = 1.f / clip.w;
+    const float x = ((clip.x * inv_w * 0.5f) + 0.5f) * _sizes.front().x();
+    const float y = ((clip.y * inv_w * 0.5f) + 0.5f) * _sizes.front().y();
+    footprint.min_x = (std::min)(footprint.min_x, x);
+    footprint.min_y = (std::min)(footprint.min_y, y);
+    footprint.max_x = (std::max)(footprint.max_x, x);
+    footprint.max_y = (std::max)(footprint.max_y, y);
+    footprint.depth = (std::min)(footprint.depth, clip.z * inv_w);
+  }
+
+  return 0 == outside;
+}
\ No newline at end of file
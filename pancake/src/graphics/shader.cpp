@@ -1,23 +1,65 @@
 #include "graphics/shader.hpp"
 
+#include <cctype>
+
 using namespace pancake;
 
-Shader::Shader(const GUID& guid) : _guid(guid) {}
+// whether glsl source uses the discard keyword, outside comments and not as part of a longer
+// identifier. a macro wrapping it still counts, since its definition names the keyword
+static bool usesDiscard(std::string_view source) {
+  const auto identifier = [](char c) {
+    return (0 != std::isalnum(static_cast<unsigned char>(c))) || ('_' == c);
+  };
+
+  size_t i = 0;
+  while (i < source.size()) {
+    if (source.substr(i, 2) == "//") {
+      i = source.find('\n', i);
+    } else if (source.substr(i, 2) == "/*") {
+      i = source.find("*/", i + 2);
+      i = (std::string_view::npos == i) ? i : (i + 2);
+    } else if (identifier(source[i])) {
+      size_t end = i;
+      while ((end < source.size()) && identifier(source[end])) {
+        ++end;
+      }
+      if (source.substr(i, end - i) == "discard") {
+        return true;
+      }
+      i = end;
+    } else {
+      ++i;
+    }
+  }
+  return false;
+}
+
+Shader::Shader(const GUID& guid) : _guid(guid), _gen(0), _discards(false) {}
 
 template <>
 void Shader::resourceUpdated<ShaderSourceTag>(const ShaderResourceInterface& res) {
-  compileVertexSource(res.getVertexSource());
-  compileFragmentSource(res.getFragmentSource());
+  setVertexSource(res.getVertexSource());
+  setFragmentSource(res.getFragmentSource());
+  _discards = usesDiscard(res.getFragmentSource());
 }
 
 void Shader::resourcesUpdated() {
   linkProgram();
+  ++_gen;
 }
 
 const GUID& Shader::guid() const {
   return _guid;
 }
 
+uint64_t Shader::gen() const {
+  return _gen;
+}
+
+bool Shader::discards() const {
+  return _discards;
+}
+
 Ptr<Shader> Shader::ptr() {
   return shared_from_this();
 }
@@ -5,24 +5,25 @@
 #include "graphics/texture.hpp"
 #include "util/componentify_json.hpp"
 #include "util/jsonify_component.hpp"
+#include "util/overloaded.hpp"
+
+#include <cstring>
 
 using namespace pancake;
 
-ShaderInput::ShaderInput(std::string_view name, Value value) : _name(name), _value(value) {}
+ShaderInput::ShaderInput(std::string_view name, Value value)
+    : _name(name), _value(value), _sub_names{_name, _name} {
+  if (std::holds_alternative<TextureRef>(_value)) {
+    _sub_names[0] = UniformId(std::string(name) + "_transform");
+  } else if (std::holds_alternative<LightInfo>(_value)) {
+    _sub_names[0] = UniformId(std::string(name) + "_position");
+    _sub_names[1] = UniformId(std::string(name) + "_color");
+  }
+}
 
 void ShaderInput::submitted(Renderer& renderer) const {
   if (std::holds_alternative<TextureRef>(_value)) {
-    const auto& tex = std::get<TextureRef>(_value);
-    if (tex.tile < 0) {
-      if (!renderer.getTexture(tex.texture).has_value()) {
-        renderer.queueTextureUpdate(tex.texture);
-      }
-    } else {
-      const auto tileset_opt = renderer.getTileset(tex.texture);
-      if (!tileset_opt.has_value()) {
-        renderer.queueTilesetUpdate(tex.texture);
-      }
-    }
+    renderer.queueTextureUpdate(std::get<TextureRef>(_value));
   }
 }
 
@@ -40,41 +41,17 @@ void ShaderInput::bind(Shader& shader, Renderer& renderer) const {
   } else if (std::holds_alternative<Mat4f>(_value)) {
     shader.setUniform(_name, std::get<Mat4f>(_value));
   } else if (std::holds_alternative<TextureRef>(_value)) {
-    const auto& tex = std::get<TextureRef>(_value);
-
-    OptTextureConstRef texture_opt;
-    OptTilesetConstRef tileset_opt;
-
-    if (const auto framebuffer_opt = renderer.getFramebuffer(tex.texture);
-        framebuffer_opt.has_value()) {
-      texture_opt = framebuffer_opt.value().get().texture(tex.tile < 0 ? 0 : tex.tile);
-    }
-
-    if (!texture_opt.has_value()) {
-      if (tex.tile < 0) {
-        texture_opt = renderer.getTexture(tex.texture);
-      } else {
-        tileset_opt = renderer.getTileset(tex.texture);
-        if (tileset_opt.has_value()) {
-          texture_opt = renderer.getTexture(tileset_opt.value().get().getTextureProps());
-        }
-      }
-    }
-
-    const Texture& texture =
-        texture_opt.has_value() ? texture_opt.value().get() : renderer.getBlankTexture();
+    Vec4f transform;
+    const Texture& texture = renderer.resolveTexture(std::get<TextureRef>(_value), transform);
 
     int slot = renderer.bindTexture(texture);
     shader.setUniform(_name, slot);
-    shader.setUniform(_name + "_transform",
-                      tileset_opt.has_value()
-                          ? tileset_opt.value().get().genTransform(tex.tile, texture.transform())
-                          : texture.transform());
+    shader.setUniform(_sub_names[0], transform);
   } else if (std::holds_alternative<LightInfo>(_value)) {
     const auto& light = std::get<LightInfo>(_value);
 
-    shader.setUniform(_name + "_position", light.position);
-    shader.setUniform(_name + "_color", light.color);
+    shader.setUniform(_sub_names[0], light.position);
+    shader.setUniform(_sub_names[1], light.color);
   }
 }
 
@@ -101,15 +78,69 @@ ShaderInput::Type ShaderInput::getType() const {
 }
 
 std::string_view ShaderInput::getName() const {
+  return _name.name();
+}
+
+const UniformId& ShaderInput::getId() const {
   return _name;
 }
 
+const TextureRef* ShaderInput::getTextureRef() const {
+  return std::get_if<TextureRef>(&_value);
+}
+
+void ShaderInput::writeStd140(std::span<std::byte> dst) const {
+  const auto write = [&dst](const void* src, size_t size) {
+    if (size <= dst.size()) {
+      std::memcpy(dst.data(), src, size);
+    }
+  };
+
+  std::visit(overloaded{[&write](int value) { write(&value, sizeof(value)); },
+                        [&write](float value) { write(&value, sizeof(value)); },
+                        [](const TextureRef&) {}, [](const LightInfo&) {},
+                        [&write](const auto& value) { write(&value.m[0][0], sizeof(value.m)); }},
+             _value);
+}
+
+static size_t hashCombine(size_t seed, size_t hash) {
+  return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+template <typename T, int W, int H>
+static size_t hashMatrix(size_t seed, const Matrix<T, W, H>& mat) {
+  for (int x = 0; x < W; ++x) {
+    for (int y = 0; y < H; ++y) {
+      seed = hashCombine(seed, std::hash<T>{}(mat.m[x][y]));
+    }
+  }
+  return seed;
+}
+
+size_t ShaderInput::hash() const {
+  const size_t seed = hashCombine(std::hash<uint32_t>{}(_name.index()), _value.index());
+  return std::visit(
+      overloaded{
+          [seed](int value) { return hashCombine(seed, std::hash<int>{}(value)); },
+          [seed](float value) { return hashCombine(seed, std::hash<float>{}(value)); },
+          [seed](const TextureRef& value) {
+            return hashCombine(hashCombine(seed, std::hash<GUID>{}(value.texture)),
+                               std::hash<int>{}(value.tile));
+          },
+          [seed](const LightInfo& value) {
+            return hashCombine(hashMatrix(hashMatrix(seed, value.position), value.color),
+                               std::hash<float>{}(value.radius));
+          },
+          [seed](const auto& value) { return hashMatrix(seed, value); }},
+      _value);
+}
+
 void ShaderInput::toJson(JSONObject& json) const {
   Type type = getType();
   TypeDescLibrary::get<Type>().visit(JSONifyComponent(json, "type", &type));
 
   std::string& name = json.getOrCreate<JSONString>("name");
-  name = _name;
+  name = _name.name();
 
   switch (type) {
     case ShaderInput::Type::Int:
@@ -204,7 +235,10 @@ std::optional<ShaderInput> ShaderInput::fromJson(const JSONObject& json) {
 }
 
 bool ShaderInput::operator<(const ShaderInput& rhs) const {
-  return std::tie(_name, _value) < std::tie(rhs._name, rhs._value);
+  if (_name != rhs._name) {
+    return _name.name() < rhs._name.name();
+  }
+  return _value < rhs._value;
 }
 
 bool ShaderInput::operator==(const ShaderInput& rhs) const {
@@ -0,0 +1,61 @@
+#include "graphics/shader_input_block.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+using namespace pancake;
+
+// sharded by hash so threads submitting draws concurrently rarely contend
+struct ShaderInputBlockPool {
+  std::mutex mutex;
+  std::unordered_multimap<size_t, WeakPtr<const ShaderInputBlock>> blocks;
+};
+
+static const size_t NUM_POOL_SHARDS = 16;
+
+static ShaderInputBlockPool& shaderInputBlockPool(size_t hash) {
+  static ShaderInputBlockPool pools[NUM_POOL_SHARDS];
+  return pools[hash % NUM_POOL_SHARDS];
+}
+
+ShaderInputBlock::ShaderInputBlock(const std::set<ShaderInput>& inputs, size_t hash)
+    : _inputs(inputs.begin(), inputs.end()), _hash(hash) {}
+
+std::span<const ShaderInput> ShaderInputBlock::inputs() const {
+  return _inputs;
+}
+
+size_t ShaderInputBlock::hash() const {
+  return _hash;
+}
+
+Ptr<const ShaderInputBlock> ShaderInputBlock::intern(const std::set<ShaderInput>& inputs) {
+  size_t hash = inputs.size();
+  for (const ShaderInput& input : inputs) {
+    hash ^= input.hash() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+
+  ShaderInputBlockPool& pool = shaderInputBlockPool(hash);
+  std::lock_guard lock(pool.mutex);
+
+  const auto [begin, end] = pool.blocks.equal_range(hash);
+  for (auto it = begin; it != end; ++it) {
+    if (Ptr<const ShaderInputBlock> block = it->second.lock();
+        (nullptr != block) && std::ranges::equal(block->_inputs, inputs)) {
+      return block;
+    }
+  }
+
+  Ptr<const ShaderInputBlock> block(new ShaderInputBlock(inputs, hash));
+  pool.blocks.emplace(hash, block);
+  return block;
+}
+
+void ShaderInputBlock::collect() {
+  for (size_t shard = 0; shard < NUM_POOL_SHARDS; ++shard) {
+    ShaderInputBlockPool& pool = shaderInputBlockPool(shard);
+    std::lock_guard lock(pool.mutex);
+    std::erase_if(pool.blocks, [](const auto& pair) { return pair.second.expired(); });
+  }
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "graphics/uniform_id.hpp"
+
+#include "util/assert.hpp"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace pancake;
+
+static constexpr uint32_t NAME_CHUNK_BITS = 8;
+static constexpr uint32_t NAME_CHUNK_SIZE = 1u << NAME_CHUNK_BITS;
+static constexpr uint32_t MAX_NAME_CHUNKS = 4096;
+
+// names are appended to chunks that never move or shrink, so name() reads them without the lock.
+// an id is only handed out once its name is written, under the lock
+struct UniformNames {
+  std::shared_mutex mutex;
+  std::deque<std::string> names;
+  std::unordered_map<std::string_view, uint32_t> indices;
+  std::vector<std::unique_ptr<std::string_view[]>> owned_chunks;
+  std::array<std::atomic<const std::string_view*>, MAX_NAME_CHUNKS> chunks = {};
+};
+
+static UniformNames& uniformNames() {
+  static UniformNames uniform_names;
+  return uniform_names;
+}
+
+UniformId::UniformId(std::string_view name) {
+  UniformNames& uniform_names = uniformNames();
+  {
+    std::shared_lock lock(uniform_names.mutex);
+    if (const auto it = uniform_names.indices.find(name); it != uniform_names.indices.end()) {
+      _index = it->second;
+      return;
+    }
+  }
+
+  std::unique_lock lock(uniform_names.mutex);
+  if (const auto it = uniform_names.indices.find(name); it != uniform_names.indices.end()) {
+    _index = it->second;
+    return;
+  }
+
+  _index = static_cast<uint32_t>(uniform_names.names.size());
+  const uint32_t chunk = _index >> NAME_CHUNK_BITS;
+  ensure(chunk < MAX_NAME_CHUNKS);
+  if (chunk == uniform_names.owned_chunks.size()) {
+    uniform_names.owned_chunks.emplace_back(new std::string_view[NAME_CHUNK_SIZE]);
+    uniform_names.chunks[chunk].store(uniform_names.owned_chunks.back().get(),
+                                      std::memory_order_release);
+  }
+
+  const std::string_view stored = uniform_names.names.emplace_back(name);
+  uniform_names.owned_chunks[chunk][_index & (NAME_CHUNK_SIZE - 1)] = stored;
+  uniform_names.indices.emplace(stored, _index);
+}
+
+uint32_t UniformId::index() const {
+  return _index;
+}
+
+std::string_view UniformId::name() const {
+  const std::string_view* chunk =
+      uniformNames().chunks[_index >> NAME_CHUNK_BITS].load(std::memory_order_acquire);
+  return chunk[_index & (NAME_CHUNK_SIZE - 1)];
+}
\ No newline at end of file
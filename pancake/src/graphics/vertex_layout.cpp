@@ -0,0 +1,121 @@
+#include "graphics/vertex_layout.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+using namespace pancake;
+
+static uint16_t toHalf(float value) {
+  const uint32_t bits = std::bit_cast<uint32_t>(value);
+  const uint32_t sign = (bits >> 16) & 0x8000;
+  const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+  const uint32_t mantissa = bits & 0x7FFFFF;
+
+  if (0x7F800000 == (bits & 0x7F800000)) {
+    return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+  }
+  if (31 <= exponent) {
+    return static_cast<uint16_t>(sign | 0x7C00);
+  }
+  if (exponent <= 0) {
+    if (exponent < -10) {
+      return static_cast<uint16_t>(sign);
+    }
+    const uint32_t denormal = (mantissa | 0x800000) >> (1 - exponent);
+    return static_cast<uint16_t>(sign | ((denormal + 0x1000) >> 13));
+  }
+
+  // rounding may carry into the exponent, which still yields the correct result
+  return static_cast<uint16_t>((sign | (exponent << 10) | (mantissa >> 13)) +
+                               ((mantissa >> 12) & 1));
+}
+
+static uint32_t toSnorm2_10_10_10(const Vec4f& value) {
+  const auto snorm = [](float v, float max, uint32_t mask) {
+    const int32_t quantised = static_cast<int32_t>(std::round(std::clamp(v, -1.f, 1.f) * max));
+    return static_cast<uint32_t>(quantised) & mask;
+  };
+  return snorm(value.x(), 511.f, 0x3FF) | (snorm(value.y(), 511.f, 0x3FF) << 10) |
+         (snorm(value.z(), 511.f, 0x3FF) << 20) | (snorm(value.w(), 1.f, 0x3) << 30);
+}
+
+static uint8_t toUnorm8(float value) {
+  return static_cast<uint8_t>(std::round(std::clamp(value, 0.f, 1.f) * 255.f));
+}
+
+static void packAttribute(const VertexAttribute& attribute, const float* value, std::byte* dst) {
+  switch (attribute.type) {
+    case VertexAttributeType::Float32:
+      std::memcpy(dst, value, sizeof(float) * attribute.components);
+      break;
+    case VertexAttributeType::Float16:
+      for (uint8_t i = 0; i < attribute.components; ++i) {
+        const uint16_t half = toHalf(value[i]);
+        std::memcpy(dst + (i * sizeof(uint16_t)), &half, sizeof(uint16_t));
+      }
+      break;
+    case VertexAttributeType::Snorm2_10_10_10: {
+      const uint32_t packed = toSnorm2_10_10_10(Vec4f(value[0], value[1], value[2], value[3]));
+      std::memcpy(dst, &packed, sizeof(uint32_t));
+      break;
+    }
+    case VertexAttributeType::Unorm8:
+      for (uint8_t i = 0; i < attribute.components; ++i) {
+        dst[i] = static_cast<std::byte>(toUnorm8(value[i]));
+      }
+      break;
+  }
+}
+
+const VertexLayout& VertexLayout::full() {
+  static constexpr VertexLayout layout(
+      {{{VertexAttributeType::Float32, 4, offsetof(Vertex, position)},
+        {VertexAttributeType::Float32, 4, offsetof(Vertex, normal)},
+        {VertexAttributeType::Float32, 4, offsetof(Vertex, tangent)},
+        {VertexAttributeType::Float32, 4, offsetof(Vertex, color)},
+        {VertexAttributeType::Float32, 2, offsetof(Vertex, uv0)},
+        {VertexAttributeType::Float32, 2, offsetof(Vertex, uv1)}}},
+      sizeof(Vertex));
+  return layout;
+}
+
+const VertexLayout& VertexLayout::compact() {
+  static constexpr VertexLayout layout({{{VertexAttributeType::Float32, 3, 0},
+                                         {VertexAttributeType::Snorm2_10_10_10, 4, 12},
+                                         {VertexAttributeType::Snorm2_10_10_10, 4, 16},
+                                         {VertexAttributeType::Unorm8, 4, 20},
+                                         {VertexAttributeType::Float16, 2, 24},
+                                         {VertexAttributeType::Float16, 2, 28}}},
+                                       32);
+  return layout;
+}
+
+const std::array<VertexAttribute, VertexLayout::NUM_ATTRIBUTES>& VertexLayout::attributes() const {
+  return _attributes;
+}
+
+size_t VertexLayout::stride() const {
+  return _stride;
+}
+
+std::span<const std::byte> VertexLayout::pack(std::span<const Vertex> vertices,
+                                              std::vector<std::byte>& scratch) const {
+  if (full() == *this) {
+    return std::as_bytes(vertices);
+  }
+
+  scratch.resize(vertices.size() * _stride);
+  std::byte* dst = scratch.data();
+  for (const Vertex& vertex : vertices) {
+    const float* members[NUM_ATTRIBUTES] = {vertex.position.m[0], vertex.normal.m[0],
+                                            vertex.tangent.m[0],  vertex.color.m[0],
+                                            vertex.uv0.m[0],      vertex.uv1.m[0]};
+    for (size_t i = 0; i < NUM_ATTRIBUTES; ++i) {
+      packAttribute(_attributes[i], members[i], dst + _attributes[i].offset);
+    }
+    dst += _stride;
+  }
+  return scratch;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#include "null/null_event_handler.hpp"
+
+using namespace pancake;
+
+NullEventHandler::NullEventHandler(uint64_t max_frames) : _max_frames(max_frames), _frames(0) {}
+
+bool NullEventHandler::handleEvents(Session& /*session*/) {
+  ++_frames;
+  return (0 != _max_frames) && (_max_frames <= _frames);
+}
\ No newline at end of file
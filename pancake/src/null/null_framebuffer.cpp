@@ -0,0 +1,44 @@
+#include "null/null_framebuffer.hpp"
+
+#include "resources/texture_props_resource.hpp"
+
+using namespace pancake;
+
+NullFramebuffer::NullFramebuffer(const GUID& guid, const FramebufferInfo& info)
+    : Framebuffer(guid) {
+  Framebuffer::update(info);
+}
+
+void NullFramebuffer::update() {
+  _render_targets.resize(_num_targets);
+  for (char i = 0; i < _num_targets; ++i) {
+    Ptr<NullTexture>& render_target = _render_targets[i];
+
+    TexturePropsResource tex_props("", GUID::gen());
+    tex_props.setSize(getSize());
+    tex_props.setFormat(_render_target_infos[i].format);
+
+    if (nullptr == render_target) {
+      render_target = std::make_shared<NullTexture>(tex_props);
+    } else {
+      render_target->update(tex_props);
+    }
+  }
+}
+
+void NullFramebuffer::bind() {}
+
+void NullFramebuffer::preRender() {}
+
+OptTextureConstRef NullFramebuffer::texture(size_t i) const {
+  if (i < _render_targets.size()) {
+    return *_render_targets[i];
+  }
+  return {};
+}
+
+void NullFramebuffer::readPixel(size_t /*attachment*/,
+                                const Vec2u& /*position*/,
+                                Vec4u& pixel) const {
+  pixel = Vec4u::zeros();
+}
\ No newline at end of file
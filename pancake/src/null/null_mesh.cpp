@@ -0,0 +1,27 @@
+#include "null/null_mesh.hpp"
+
+using namespace pancake;
+
+NullMesh::NullMesh(const GUID& guid) : Mesh(guid), _num_vertices(0), _num_indices(0) {}
+
+void NullMesh::update(std::span<const Vertex> vertices,
+                      std::span<const unsigned int> indices,
+                      const VertexLayout& /*layout*/,
+                      std::span<const unsigned int> /*lod_indices*/,
+                      std::span<const MeshLod> lods) {
+  _num_vertices = vertices.size();
+  _num_indices = indices.size();
+  updateShape(vertices, indices, lods);
+}
+
+void NullMesh::draw(unsigned int /*num_instances*/,
+                    unsigned int /*first_instance*/,
+                    uint32_t /*lod*/) const {}
+
+size_t NullMesh::numVertices() const {
+  return _num_vertices;
+}
+
+size_t NullMesh::numIndices() const {
+  return _num_indices;
+}
\ No newline at end of file
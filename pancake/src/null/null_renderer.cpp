@@ -0,0 +1,152 @@
+#include "null/null_renderer.hpp"
+
+#include "null/null_framebuffer.hpp"
+#include "null/null_mesh.hpp"
+#include "null/null_shader.hpp"
+#include "null/null_texture.hpp"
+#include "null/null_uniform_buffer.hpp"
+#include "resources/resources.hpp"
+#include "resources/texture_props_resource.hpp"
+#include "util/fewi.hpp"
+
+using namespace pancake;
+
+NullRenderer::NullRenderer() : _stats(), _sprite_shader(GUID::gen()) {
+  _meshes.emplace(GUID::null, createMesh(GUID::null).release());
+  _textures.emplace(GUID::null, createTexture(TexturePropsResource("", GUID::null)));
+  _shaders.emplace(GUID::null, new NullShader(GUID::null));
+  _shaders.emplace(_sprite_shader, new NullShader(_sprite_shader));
+  _stats.shaders_created += 2;
+}
+
+NullRenderer::~NullRenderer() {
+  FEWI::info() << "Null renderer : " << _stats.frames << " frames, " << _stats.draw_calls
+               << " draw calls, " << _stats.instances << " instances, " << _stats.sprites
+               << " sprites, " << _stats.texture_binds << " texture binds, "
+               << _stats.meshes_created << " meshes, " << _stats.textures_created << " textures, "
+               << _stats.shaders_created << " shaders";
+}
+
+int NullRenderer::bindTexture(const Texture& /*texture*/) {
+  ++_stats.texture_binds;
+  return 0;
+}
+
+const Texture& NullRenderer::getBlankTexture() const {
+  return *_textures.at(GUID::null);
+}
+
+Ptr<Mesh> NullRenderer::getUnitSquare() const {
+  return _meshes.at(GUID::null);
+}
+
+Ptr<Shader> NullRenderer::getDefaultShader() const {
+  return _shaders.at(GUID::null);
+}
+
+Ptr<Shader> NullRenderer::getSpriteShader() const {
+  return _shaders.at(_sprite_shader);
+}
+
+void NullRenderer::preRender(Session& session, Resources& resources) {
+  Renderer::preRender(session, resources);
+
+  for (auto& [_, tex] : _textures) {
+    tex->update(resources);
+  }
+
+  for (const auto& [_, shader] : _shaders) {
+    shader->checkAndApplyResourceUpdates(resources);
+  }
+}
+
+void NullRenderer::render() {
+  Renderer::render();
+  ++_stats.frames;
+}
+
+const NullRenderer::Stats& NullRenderer::stats() const {
+  return _stats;
+}
+
+void NullRenderer::drawMeshInstances(const Mesh& /*mesh*/,
+                                     uint32_t /*lod*/,
+                                     std::span<const CommonPerInstanceData> cpids) {
+  if (cpids.empty()) {
+    return;
+  }
+
+  ++_stats.draw_calls;
+  _stats.instances += cpids.size();
+}
+
+void NullRenderer::drawSpriteInstances(std::span<const SpriteInstanceData> sprites) {
+  if (sprites.empty()) {
+    return;
+  }
+
+  ++_stats.draw_calls;
+  _stats.sprites += sprites.size();
+}
+
+Texture* NullRenderer::createTexture(const TexturePropsResource& texture_props) {
+  ++_stats.textures_created;
+  return new NullTexture(texture_props);
+}
+
+std::unique_ptr<Framebuffer> NullRenderer::createFramebuffer(const GUID& guid,
+                                                             const FramebufferInfo& info) {
+  ++_stats.framebuffers_created;
+  return std::make_unique<NullFramebuffer>(guid, info);
+}
+
+std::unique_ptr<Mesh> NullRenderer::createMesh(const GUID& guid) {
+  ++_stats.meshes_created;
+  return std::unique_ptr<Mesh>(new NullMesh(guid));
+}
+
+std::unique_ptr<Mesh> NullRenderer::createMesh(const GUID& guid,
+                                               std::span<const Vertex> vertices,
+                                               std::span<const unsigned int> indices) {
+  std::unique_ptr<Mesh> mesh = createMesh(guid);
+  mesh->update(vertices, indices);
+  return mesh;
+}
+
+std::unique_ptr<Shader> NullRenderer::createShader(const ShaderResourceInterface& res) {
+  ++_stats.shaders_created;
+  return std::unique_ptr<Shader>(new NullShader(res.asResource().guid()));
+}
+
+std::unique_ptr<UniformBuffer> NullRenderer::createUniformBuffer() {
+  ++_stats.uniform_buffers_created;
+  return std::make_unique<NullUniformBuffer>();
+}
+
+size_t NullRenderer::uniformBufferOffsetAlignment() const {
+  return 256;
+}
+
+void NullRenderer::useDrawOptions(const DrawOptions& /*options*/) {
+  ++_stats.draw_option_changes;
+}
+
+void NullRenderer::uploadInstances(std::span<const CommonPerInstanceData> cpids) {
+  _stats.uploaded_instances += cpids.size();
+}
+
+void NullRenderer::uploadSpriteInstances(std::span<const SpriteInstanceData> sprites) {
+  _stats.uploaded_sprites += sprites.size();
+}
+
+void NullRenderer::copyToScreen(Framebuffer& /*framebuffer*/) {
+  ++_stats.screen_copies;
+}
+
+void NullRenderer::blit(Framebuffer& /*dst*/, const Framebuffer& /*src*/) {
+  ++_stats.blits;
+}
+
+void NullRenderer::beginGPUTimer(std::string /*name*/) {}
+
+void NullRenderer::endGPUTimer() {}
\ No newline at end of file
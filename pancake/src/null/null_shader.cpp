@@ -0,0 +1,31 @@
+#include "null/null_shader.hpp"
+
+using namespace pancake;
+
+NullShader::NullShader(const GUID& guid) : Shader(guid) {
+  setResourceGuid<ShaderResourceInterface, ShaderSourceTag>(guid);
+}
+
+void NullShader::setVertexSource(std::string_view /*source*/) {}
+
+void NullShader::setFragmentSource(std::string_view /*source*/) {}
+
+void NullShader::linkProgram() {}
+
+void NullShader::use() const {}
+
+void NullShader::setUniform(const UniformId& /*id*/, int /*value*/) const {}
+
+void NullShader::setUniform(const UniformId& /*id*/, float /*value*/) const {}
+
+void NullShader::setUniform(const UniformId& /*id*/, const Vec3f& /*value*/) const {}
+
+void NullShader::setUniform(const UniformId& /*id*/, const Vec4f& /*value*/) const {}
+
+void NullShader::setUniform(const UniformId& /*id*/, const Vec4u& /*value*/) const {}
+
+void NullShader::setUniform(const UniformId& /*id*/, const Mat4f& /*value*/) const {}
+
+const UniformBlockLayout* NullShader::getUniformBlockLayout(UniformBlock /*block*/) const {
+  return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+#include "null/null_texture.hpp"
+
+using namespace pancake;
+
+NullTexture::NullTexture(const TexturePropsResource& texture_props) : Texture(texture_props) {}
+
+void NullTexture::bind(int /*slot*/) const {}
\ No newline at end of file
@@ -0,0 +1,7 @@
+#include "null/null_uniform_buffer.hpp"
+
+using namespace pancake;
+
+void NullUniformBuffer::update(std::span<const std::byte> /*data*/) {}
+
+void NullUniformBuffer::bind(UniformBlock /*block*/, size_t /*offset*/, size_t /*size*/) const {}
\ No newline at end of file
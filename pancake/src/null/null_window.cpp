@@ -0,0 +1,47 @@
+#include "null/null_window.hpp"
+
+#if defined(PANCAKE_ENABLE_IMGUI)
+#include "imgui/imgui.h"
+#endif
+
+using namespace pancake;
+
+NullWindow::NullWindow(const Vec2i& size) : _size(size) {
+#if defined(PANCAKE_ENABLE_IMGUI)
+  IMGUI_CHECKVERSION();
+  ImGui::CreateContext();
+
+  // without a renderer backend the font atlas has to be built by hand before the first frame
+  ImGuiIO& io = ImGui::GetIO();
+  io.DisplaySize = ImVec2(static_cast<float>(_size.x()), static_cast<float>(_size.y()));
+  unsigned char* pixels = nullptr;
+  int width = 0;
+  int height = 0;
+  io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+  ImGui::NewFrame();
+#endif
+}
+
+NullWindow::~NullWindow() {
+#if defined(PANCAKE_ENABLE_IMGUI)
+  ImGui::DestroyContext();
+#endif
+}
+
+void NullWindow::newImGuiFrame() {
+#if defined(PANCAKE_ENABLE_IMGUI)
+  ImGui::EndFrame();
+  ImGui::NewFrame();
+#endif
+}
+
+void NullWindow::flip() {
+#if defined(PANCAKE_ENABLE_IMGUI)
+  ImGui::Render();
+#endif
+}
+
+Vec2i NullWindow::size() const {
+  return _size;
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "resources/gltf_primitive_resource.hpp"
 
+#include "graphics/mesh_lod.hpp"
+#include "graphics/mesh_optimiser.hpp"
 #include "resources/gltf_resource.hpp"
 #include "resources/resources.hpp"
 #include "util/componentify_json.hpp"
@@ -177,6 +179,8 @@ template <>
 void GltfPrimitiveResource::resourceUpdated<GltfTag>(const GltfResource& res) {
   _vertices.clear();
   _indices.clear();
+  _lod_indices.clear();
+  _lods.clear();
 
   bool success = true;
 
@@ -296,7 +300,10 @@ void GltfPrimitiveResource::resourceUpdated<GltfTag>(const GltfResource& res) {
     success = false;
   }
 
-  if (!success) {
+  if (success) {
+    optimiseMesh(_vertices, _indices);
+    buildMeshLods(_vertices, _indices, _lod_indices, _lods);
+  } else {
     FEWI::error() << "Failed to load primitive #" << _primitive << " from mesh #" << _mesh << " at "
                   << res.path() << " !";
   }
@@ -318,6 +325,14 @@ std::span<const unsigned int> GltfPrimitiveResource::getIndices() const {
   return _indices;
 }
 
+std::span<const unsigned int> GltfPrimitiveResource::getLodIndices() const {
+  return _lod_indices;
+}
+
+std::span<const MeshLod> GltfPrimitiveResource::getLods() const {
+  return _lods;
+}
+
 Resource& GltfPrimitiveResource::asResource() {
   return *this;
 }
@@ -8,6 +8,8 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 
@@ -96,38 +98,38 @@ void ImageResource::blit(const ImageResource& res,
                          int src_h) {
   const unsigned char* res_data = res.data();
   const int res_width = res.width();
-  const int res_height = res.height();
   const int res_channels = res.channels();
 
-  const int i_max = std::min(src_x + src_w, res_width);
-  const int j_max = std::min(src_y + src_h, res_height);
+  const int i_min = (std::max)({0, src_x, src_x - dst_x});
+  const int i_max = (std::min)({src_x + src_w, res_width, src_x + (_size.x() - dst_x)});
+  const int j_min = (std::max)({0, src_y, src_y - dst_y});
+  const int j_max = (std::min)({src_y + src_h, res.height(), src_y + (_size.y() - dst_y)});
+  if ((i_max <= i_min) || (j_max <= j_min)) {
+    return;
+  }
+
+  for (int j = j_min; j < j_max; ++j) {
+    unsigned char* dst_row =
+        _data + ((((dst_y + j - src_y) * _size.x()) + dst_x + i_min - src_x) * _channels);
+    const unsigned char* src_row = res_data + (((j * res_width) + i_min) * res_channels);
 
-  for (int i = src_x; i < i_max; ++i) {
-    int ix = dst_x + i;
-    if (ix < 0) {
+    // matching layouts copy whole rows at once
+    if (res_channels == _channels) {
+      std::memcpy(dst_row, src_row, static_cast<size_t>(i_max - i_min) * _channels);
       continue;
     }
-    if (_size.x() < ix) {
-      break;
-    }
-
-    for (int j = 0; j < j_max; ++j) {
-      int jy = j + dst_y;
-      if (jy < 0) {
-        continue;
-      }
-      if (_size.y() < jy) {
-        break;
-      }
 
+    for (int i = i_min; i < i_max; ++i) {
       for (int c = 0; (c < _channels) && (c < res_channels); ++c) {
-        _data[(((jy * _size.x()) + ix) * _channels) + c] =
-            res_data[(((j * res_width) + i) * res_channels) + c];
+        dst_row[c] = src_row[c];
       }
 
       for (int c = res_channels; c < _channels; ++c) {
-        _data[(((jy * _size.y()) + ix) * _channels) + c] = 255;
+        dst_row[c] = 255;
       }
+
+      dst_row += _channels;
+      src_row += res_channels;
     }
   }
   updated();
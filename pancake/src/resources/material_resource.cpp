@@ -22,6 +22,9 @@ void MaterialResource::_load() {
   if (const JSONValue* val = _json.get("depth_test"); nullptr != val) {
     TypeDescLibrary::get<bool>().visit(ComponentifyJSON(&_depth_test, *val));
   }
+  if (const JSONValue* val = _json.get("opaque"); nullptr != val) {
+    TypeDescLibrary::get<bool>().visit(ComponentifyJSON(&_opaque, *val));
+  }
   if (const JSONValue* val = _json.get("stage"); nullptr != val) {
     TypeDescLibrary::get<int>().visit(ComponentifyJSON(&_stage, *val));
   }
@@ -47,6 +50,7 @@ void MaterialResource::_save() {
   _json.clear();
   TypeDescLibrary::get<GUID>().visit(JSONifyComponent(_json, "shader", &_shader));
   TypeDescLibrary::get<bool>().visit(JSONifyComponent(_json, "depth_test", &_depth_test));
+  TypeDescLibrary::get<bool>().visit(JSONifyComponent(_json, "opaque", &_opaque));
   TypeDescLibrary::get<int>().visit(JSONifyComponent(_json, "stage", &_stage));
   _json.getOrCreate<JSONString>("light_pass_input_name") += _light_pass_input_name;
   _json.getOrCreate<JSONString>("view_input_name") += _view_input_name;
@@ -71,6 +75,12 @@ void MaterialResource::setDepthTest(bool value) {
   _depth_test = value;
   updated();
 }
+
+void MaterialResource::setOpaque(bool value) {
+  _opaque = value;
+  updated();
+}
+
 void MaterialResource::setStage(int stage) {
   _stage = stage;
   updated();
@@ -106,6 +116,10 @@ bool MaterialResource::getDepthTest() const {
   return _depth_test;
 }
 
+bool MaterialResource::getOpaque() const {
+  return _opaque;
+}
+
 int MaterialResource::getStage() const {
   return _stage;
 }
@@ -1,5 +1,7 @@
 #include "resources/obj_mesh_resource.hpp"
 
+#include "graphics/mesh_lod.hpp"
+#include "graphics/mesh_optimiser.hpp"
 #include "resources/resources.hpp"
 #include "util/componentify_json.hpp"
 #include "util/jsonify_component.hpp"
@@ -60,6 +62,8 @@ template <>
 void ObjMeshResource::resourceUpdated<ObjTag>(const ObjResource& res) {
   _vertices.clear();
   _indices.clear();
+  _lod_indices.clear();
+  _lods.clear();
 
   std::span<const Vertex> vertices = res.getVertices(_name);
   _vertices.insert(_vertices.begin(), vertices.begin(), vertices.end());
@@ -67,6 +71,9 @@ void ObjMeshResource::resourceUpdated<ObjTag>(const ObjResource& res) {
   std::span<const unsigned int> indices = res.getIndices(_name);
   _indices.insert(_indices.begin(), indices.begin(), indices.end());
 
+  optimiseMesh(_vertices, _indices);
+  buildMeshLods(_vertices, _indices, _lod_indices, _lods);
+
   updated();
 }
 
@@ -84,6 +91,14 @@ std::span<const unsigned int> ObjMeshResource::getIndices() const {
   return _indices;
 }
 
+std::span<const unsigned int> ObjMeshResource::getLodIndices() const {
+  return _lod_indices;
+}
+
+std::span<const MeshLod> ObjMeshResource::getLods() const {
+  return _lods;
+}
+
 Resource& ObjMeshResource::asResource() {
   return *this;
 }
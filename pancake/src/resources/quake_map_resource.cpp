@@ -1,5 +1,6 @@
 #include "resources/quake_map_resource.hpp"
 
+#include "graphics/mesh_optimiser.hpp"
 #include "resources/resources.hpp"
 
 using namespace pancake;
@@ -18,6 +19,7 @@ void QuakeMapResource::_load() {
   QuakeMap::tokenize(_text, tokens);
   _map.parse(tokens);
   _map.genBrushesMesh(_vertices, _indices);
+  optimiseMesh(_vertices, _indices);
 }
 
 std::span<const Vertex> QuakeMapResource::getVertices() const {
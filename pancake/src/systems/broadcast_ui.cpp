@@ -29,8 +29,9 @@ void BroadcastUI::_run(const SessionWrapper& session,
         fb_opt.has_value()) {
       const auto& [fb_base, fb_info] = fb_opt.value();
       framebuffer = fb_base->guid;
-      fb_centre = Vec2f(fb_info->size) * 0.5f;
-      fb_size = static_cast<float>(std::max(fb_info->size.x(), fb_info->size.y()));
+      const Vec2i layout_size = session.renderer().layoutSize(*fb_info);
+      fb_centre = Vec2f(layout_size) * 0.5f;
+      fb_size = static_cast<float>(std::max(layout_size.x(), layout_size.y()));
     }
 
     QuadTree<Entity>* ui_tree = nullptr;
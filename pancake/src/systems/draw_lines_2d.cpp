@@ -2,51 +2,132 @@
 
 #include "components/2d.hpp"
 #include "core/renderer.hpp"
-#include "core/session.hpp"
 #include "core/session_access.hpp"
 #include "core/session_wrapper.hpp"
 #include "ecs/components.hpp"
 #include "ecs/world_wrapper.hpp"
-#include "graphics/mesh.hpp"
-#include "graphics/shader.hpp"
 #include "graphics/shader_input.hpp"
 
+#include <span>
+
 using namespace pancake;
 
 const DrawSystem::StaticAdder<DrawLines2D> draw_lines_2d_adder{};
 
-void DrawLines2D::_configure(Session& session) {
-  Renderer& renderer = session.renderer();
-  _mesh = renderer.getUnitSquare()->guid();
-  _shader = renderer.getDefaultShader()->guid();
+// joins sharper than this are clamped rather than letting the miter grow unbounded
+static const float MITER_LIMIT = 4.f;
+
+static Vec2f perpendicular(const Vec2f& dir) {
+  return Vec2f(-dir.y(), dir.x());
+}
+
+static void tessellatePolyline(std::span<const Vec2f> points,
+                               float width,
+                               std::vector<Vertex>& vertices,
+                               std::vector<unsigned int>& indices) {
+  const float half_width = width * 0.5f;
+  const unsigned int first_vertex = static_cast<unsigned int>(vertices.size());
+
+  for (size_t i = 0; i < points.size(); ++i) {
+    const Vec2f& point = points[i];
+
+    Vec2f offset;
+    if (0 == i) {
+      offset = perpendicular((points[i + 1] - point).normalised()) * half_width;
+    } else if ((points.size() - 1) == i) {
+      offset = perpendicular((point - points[i - 1]).normalised()) * half_width;
+    } else {
+      const Vec2f normal_in = perpendicular((point - points[i - 1]).normalised());
+      const Vec2f normal_out = perpendicular((points[i + 1] - point).normalised());
+      const Vec2f miter = normal_in + normal_out;
+      if (miter.squaredNorm() < 0.0001f) {
+        offset = normal_in * half_width;
+      } else {
+        const Vec2f miter_dir = miter.normalised();
+        const float cos_half_angle = (std::max)(miter_dir.dot(normal_in), 1.f / MITER_LIMIT);
+        offset = miter_dir * (half_width / cos_half_angle);
+      }
+    }
+
+    for (const Vec2f& position : {point + offset, point - offset}) {
+      Vertex& vertex = vertices.emplace_back();
+      vertex.position = Vec4f(position.x(), position.y(), 0.f, 0.f);
+      vertex.normal = Vec4f(0.f, 0.f, 1.f, 0.f);
+      vertex.tangent = Vec4f(1.f, 0.f, 0.f, 0.f);
+      vertex.color = Vec4f::ones();
+    }
+  }
+
+  for (unsigned int i = 0; (i + 1) < points.size(); ++i) {
+    const unsigned int base = first_vertex + (i * 2);
+    for (const unsigned int index : {base, base + 1, base + 2, base + 1, base + 3, base + 2}) {
+      indices.push_back(index);
+    }
+  }
 }
 
-void DrawLines2D::_run(const SessionWrapper& session, const WorldWrapper& world) const {
+void DrawLines2D::_run(const SessionWrapper& session,
+                       const WorldWrapper& world,
+                       PolylineBatches& batches) const {
   Renderer& renderer = session.renderer();
   static const TextureRef blank_tex;
 
-  for (const auto& [line, points] : world.getComponents<const LineRenderer2D, const Points2D>()) {
-    const Vec2f* prev_point = nullptr;
-    for (const Vec2f& point : *points) {
-      if (nullptr != prev_point) {
-        Transform2D transform;
-        {
-          const Vec2f& a = *prev_point;
-          const Vec2f& b = point;
-          Transform2D::Accessor accessor = transform.modify();
-          accessor.translation() = (a + b) * 0.5f;
-          accessor.rotation() = (b - a).atan2();
-          accessor.scale().x() = (b - a).norm();
-          accessor.scale().y() = line->width;
-        }
-
-        session.renderer().submit(
-            line->camera_mask, GUID::null,
-            {ShaderInput("colour", line->colour), ShaderInput("tex", blank_tex)}, _mesh,
-            transform.matrix3D());
+  for (auto& [_, batch] : batches) {
+    batch.vertices.clear();
+    batch.indices.clear();
+  }
+
+  std::vector<Vec2f> points;
+  for (const auto& [line, line_points] :
+       world.getComponents<const LineRenderer2D, const Points2D>()) {
+    points.clear();
+    for (const Vec2f& point : *line_points) {
+      if (points.empty() || (points.back() != point)) {
+        points.push_back(point);
       }
-      prev_point = &point;
     }
+    if (points.size() < 2) {
+      continue;
+    }
+
+    auto it = batches.find({line->camera_mask, line->colour});
+    if (it == batches.end()) {
+      PolylineBatch batch;
+      batch.mesh = GUID::gen();
+      batch.inputs = ShaderInputBlock::intern(
+          {ShaderInput("colour", line->colour), ShaderInput("tex", blank_tex)});
+      it = batches.emplace(std::pair(line->camera_mask, line->colour), std::move(batch)).first;
+    }
+
+    tessellatePolyline(points, line->width, it->second.vertices, it->second.indices);
+  }
+
+  for (auto it = batches.begin(); it != batches.end();) {
+    PolylineBatch& batch = it->second;
+    if (batch.indices.empty()) {
+      renderer.submitRetainedRelease(batch.mesh);
+      renderer.submitMeshRelease(batch.mesh);
+      it = batches.erase(it);
+      continue;
+    }
+
+    // static lines are only uploaded and resubmitted when their tessellation changes
+    if ((batch.vertices != batch.uploaded_vertices) || (batch.indices != batch.uploaded_indices)) {
+      batch.uploaded_vertices = batch.vertices;
+      batch.uploaded_indices = batch.indices;
+      renderer.submitMeshUpdate(batch.mesh, batch.vertices, batch.indices);
+      renderer.submitRetained(batch.mesh, it->first.first, GUID::null, batch.inputs, batch.mesh,
+                              Mat4f::identity());
+    }
+    ++it;
+  }
+}
+
+void DrawLines2D::_releaseCache(Session& session, PolylineBatches& batches) const {
+  Renderer& renderer = session.renderer();
+  for (const auto& [_, batch] : batches) {
+    renderer.submitRetainedRelease(batch.mesh);
+    renderer.submitMeshRelease(batch.mesh);
   }
 }
 
@@ -59,7 +140,7 @@ SystemId DrawLines2D::id() const {
 }
 
 const SessionAccess& DrawLines2D::getSessionAccess() const {
-  static const SessionAccess session_access = SessionAccess().addRenderer();
+  static const SessionAccess session_access = SessionAccess().addRendererSubmit();
   return session_access;
 }
 
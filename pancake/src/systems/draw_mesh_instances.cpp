@@ -9,19 +9,63 @@
 #include "ecs/world_wrapper.hpp"
 #include "graphics/shader.hpp"
 #include "graphics/shader_input.hpp"
+#include "graphics/shader_input_block.hpp"
 #include "systems/submit_lights.hpp"
 
 using namespace pancake;
 
 const DrawSystem::StaticAdder<DrawMeshInstances> draw_mesh_instances_adder{};
 
-void DrawMeshInstances::_run(const SessionWrapper& session, const WorldWrapper& world) const {
+void DrawMeshInstances::_run(const SessionWrapper& session,
+                             const WorldWrapper& world,
+                             RetainedMeshInstances& instances) const {
   Renderer& renderer = session.renderer();
+  static const Ptr<const ShaderInputBlock> no_overrides = ShaderInputBlock::intern({});
+
+  for (auto& [_, instance] : instances) {
+    instance.used = false;
+  }
+
+  // instances are retained by the renderer, so only new or changed ones are resubmitted
   for (const auto& [base, transform, mesh, material] :
        world.getComponents<const Base, const Transform3D, const MeshInstance,
                            const MaterialInstance>()) {
-    Mat4f model = transform->matrix();
-    renderer.submit(mesh->camera_mask, material->material, {}, mesh->mesh, model, base->self);
+    if (world.hasComponent<StaticMesh>(base->self)) {
+      continue;
+    }
+
+    const Mat4f model = transform->matrix();
+    const auto [it, inserted] = instances.try_emplace(base->self);
+    RetainedMeshInstance& instance = it->second;
+    if (inserted) {
+      instance.id = GUID::gen();
+    }
+
+    if (inserted || (instance.camera_mask != mesh->camera_mask) ||
+        (instance.material != material->material) || (instance.mesh != mesh->mesh) ||
+        (instance.model != model)) {
+      instance.camera_mask = mesh->camera_mask;
+      instance.material = material->material;
+      instance.mesh = mesh->mesh;
+      instance.model = model;
+      renderer.submitRetained(instance.id, mesh->camera_mask, material->material, no_overrides,
+                              mesh->mesh, model, base->self);
+    }
+    instance.used = true;
+  }
+
+  std::erase_if(instances, [&renderer](const auto& pair) {
+    if (!pair.second.used) {
+      renderer.submitRetainedRelease(pair.second.id);
+    }
+    return !pair.second.used;
+  });
+}
+
+void DrawMeshInstances::_releaseCache(Session& session, RetainedMeshInstances& instances) const {
+  Renderer& renderer = session.renderer();
+  for (const auto& [_, instance] : instances) {
+    renderer.submitRetainedRelease(instance.id);
   }
 }
 
@@ -34,13 +78,13 @@ SystemId DrawMeshInstances::id() const {
 }
 
 const SessionAccess& DrawMeshInstances::getSessionAccess() const {
-  static const SessionAccess session_access = SessionAccess().addRenderer();
+  static const SessionAccess session_access = SessionAccess().addRendererSubmit();
   return session_access;
 }
 
 const ComponentAccess& DrawMeshInstances::getComponentAccess() const {
   static const ComponentAccess component_access =
       Components::getAccess<const Base, const Transform3D, const MeshInstance,
-                            const MaterialInstance>();
+                            const MaterialInstance, const StaticMesh>();
   return component_access;
 }
\ No newline at end of file
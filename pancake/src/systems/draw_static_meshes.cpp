@@ -0,0 +1,180 @@
+#include "systems/draw_static_meshes.hpp"
+
+#include "components/3d.hpp"
+#include "core/renderer.hpp"
+#include "core/session_access.hpp"
+#include "core/session_wrapper.hpp"
+#include "ecs/components.hpp"
+#include "ecs/world_wrapper.hpp"
+#include "graphics/shader_input_block.hpp"
+#include "graphics/vertex.hpp"
+#include "graphics/vertex_layout.hpp"
+#include "resources/mesh_resource_interface.hpp"
+#include "resources/resources.hpp"
+
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+using namespace pancake;
+
+const DrawSystem::StaticAdder<DrawStaticMeshes> draw_static_meshes_adder{};
+
+// world space edge length of the cells static geometry is split into
+static const float CELL_SIZE = 32.f;
+
+// batches are split before they outgrow 16 bit indices
+static const size_t MAX_BATCH_VERTICES = 0x10000;
+
+struct StaticBatchBuilder {
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+  uint64_t id = 0;
+};
+
+using StaticBatchKey = std::tuple<GUID, CameraMask, int, int, int>;
+
+static Vec3f transformDirection(const Mat4f& matrix, const Vec4f& dir) {
+  const Vec3f transformed = (matrix * Vec4f(dir.xyz(), 0.f)).xyz();
+  return (0.f < transformed.squaredNorm()) ? transformed.normalised() : transformed;
+}
+
+static void buildBatches(Resources& resources,
+                         const std::vector<StaticMember>& members,
+                         std::map<StaticBatchKey, std::vector<StaticBatchBuilder>>& builders) {
+  std::vector<Vertex> world_vertices;
+
+  // a member's vertices as remapped into each builder its triangles land in, keyed by builder id
+  // and vertex index so it only grows with the triangles binned, not the cells they span
+  std::unordered_map<uint64_t, unsigned int> remap;
+  uint64_t num_builders = 0;
+
+  for (size_t m = 0; m < members.size(); ++m) {
+    const StaticMember& member = members[m];
+    const auto mesh_opt = resources.getOrCreate<MeshResourceInterface>(member.mesh);
+    if (!mesh_opt.has_value()) {
+      continue;
+    }
+
+    const MeshResourceInterface& mesh = mesh_opt.value().get();
+    const std::span<const Vertex> vertices = mesh.getVertices();
+    const std::span<const unsigned int> indices = mesh.getIndices();
+
+    remap.clear();
+    world_vertices.clear();
+    world_vertices.reserve(vertices.size());
+    for (const Vertex& vertex : vertices) {
+      Vertex& world = world_vertices.emplace_back(vertex);
+      world.position = member.model * Vec4f(vertex.position.xyz(), 1.f);
+      world.normal = Vec4f(transformDirection(member.normal_matrix, vertex.normal), 0.f);
+      world.tangent = Vec4f(transformDirection(member.model, vertex.tangent), vertex.tangent.w());
+    }
+
+    // triangles are binned by centroid so a single large mesh, like a quake map, still splits
+    for (size_t i = 0; (i + 2) < indices.size(); i += 3) {
+      const unsigned int* tri = &indices[i];
+      const Vec3f centroid = (world_vertices[tri[0]].position.xyz() +
+                              world_vertices[tri[1]].position.xyz() +
+                              world_vertices[tri[2]].position.xyz()) /
+                             3.f;
+      const StaticBatchKey key(member.material, member.camera_mask,
+                               static_cast<int>(std::floor(centroid.x() / CELL_SIZE)),
+                               static_cast<int>(std::floor(centroid.y() / CELL_SIZE)),
+                               static_cast<int>(std::floor(centroid.z() / CELL_SIZE)));
+
+      std::vector<StaticBatchBuilder>& chunks = builders[key];
+      if (chunks.empty() || (MAX_BATCH_VERTICES < (chunks.back().vertices.size() + 3))) {
+        chunks.emplace_back().id = num_builders++;
+      }
+
+      StaticBatchBuilder& builder = chunks.back();
+      for (size_t v = 0; v < 3; ++v) {
+        const auto [it, inserted] = remap.try_emplace(
+            (builder.id << 32) | tri[v], static_cast<unsigned int>(builder.vertices.size()));
+        if (inserted) {
+          builder.vertices.push_back(world_vertices[tri[v]]);
+        }
+        builder.indices.push_back(it->second);
+      }
+    }
+  }
+}
+
+void DrawStaticMeshes::_run(const SessionWrapper& session,
+                            const WorldWrapper& world,
+                            StaticBatches& cache) const {
+  Renderer& renderer = session.renderer();
+  Resources& resources = session.resources();
+
+  std::vector<StaticMember> members;
+  for (const auto& [base, transform, mesh, material, _] :
+       world.getComponents<const Base, const Transform3D, const MeshInstance,
+                           const MaterialInstance, const StaticMesh>()) {
+    uint64_t mesh_gen = 0;
+    if (const auto mesh_opt = resources.getOrCreate<MeshResourceInterface>(mesh->mesh);
+        mesh_opt.has_value()) {
+      mesh_gen = mesh_opt.value().get().asResource().gen();
+    }
+    members.emplace_back(base->self, mesh->mesh, mesh_gen, material->material, mesh->camera_mask,
+                         transform->matrix(), transform->inverseMatrix().transpose());
+  }
+
+  static const Ptr<const ShaderInputBlock> no_overrides = ShaderInputBlock::intern({});
+
+  // batches are only rebuilt when a static instance is added, removed or its mesh reloads
+  if (members != cache.members) {
+    for (const StaticBatch& batch : cache.batches) {
+      renderer.submitRetainedRelease(batch.mesh);
+      renderer.submitMeshRelease(batch.mesh);
+    }
+    cache.batches.clear();
+    cache.members = std::move(members);
+
+    std::map<StaticBatchKey, std::vector<StaticBatchBuilder>> builders;
+    buildBatches(resources, cache.members, builders);
+
+    for (auto& [key, chunks] : builders) {
+      for (StaticBatchBuilder& builder : chunks) {
+        StaticBatch& batch = cache.batches.emplace_back();
+        batch.mesh = GUID::gen();
+        batch.material = std::get<0>(key);
+        batch.camera_mask = std::get<1>(key);
+        renderer.submitMeshUpdate(batch.mesh, std::move(builder.vertices),
+                                  std::move(builder.indices), VertexLayout::compact());
+
+        // batches are retained under their mesh's guid until the next rebuild
+        renderer.submitRetained(batch.mesh, batch.camera_mask, batch.material, no_overrides,
+                                batch.mesh, Mat4f::identity());
+      }
+    }
+  }
+}
+
+void DrawStaticMeshes::_releaseCache(Session& session, StaticBatches& cache) const {
+  Renderer& renderer = session.renderer();
+  for (const StaticBatch& batch : cache.batches) {
+    renderer.submitRetainedRelease(batch.mesh);
+    renderer.submitMeshRelease(batch.mesh);
+  }
+}
+
+std::string_view DrawStaticMeshes::name() const {
+  return "DrawStaticMeshes";
+}
+
+SystemId DrawStaticMeshes::id() const {
+  return System::id<DrawStaticMeshes>();
+}
+
+const SessionAccess& DrawStaticMeshes::getSessionAccess() const {
+  static const SessionAccess session_access = SessionAccess().addRendererSubmit().addResources();
+  return session_access;
+}
+
+const ComponentAccess& DrawStaticMeshes::getComponentAccess() const {
+  static const ComponentAccess component_access =
+      Components::getAccess<const Base, const Transform3D, const MeshInstance,
+                            const MaterialInstance, const StaticMesh>();
+  return component_access;
+}
\ No newline at end of file
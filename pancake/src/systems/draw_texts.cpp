@@ -2,46 +2,130 @@
 
 #include "components/2d.hpp"
 #include "components/ui.hpp"
+#include "core/renderer.hpp"
 #include "core/session.hpp"
 #include "core/session_access.hpp"
 #include "core/session_wrapper.hpp"
-#include "core/window.hpp"
 #include "ecs/components.hpp"
 #include "ecs/world_wrapper.hpp"
-#include "gl3/gl3_renderer.hpp"
-#include "graphics/mesh.hpp"
-#include "graphics/shader.hpp"
 #include "graphics/shader_input.hpp"
-#include "graphics/texture.hpp"
+#include "graphics/tileset.hpp"
+#include "graphics/vertex.hpp"
 #include "resources/resources.hpp"
 #include "resources/text_resource.hpp"
+#include "resources/texture_props_resource.hpp"
 #include "resources/tileset_resource.hpp"
 #include "util/fewi.hpp"
 
+#include <limits>
+
 using namespace pancake;
 
 const DrawSystem::StaticAdder<DrawTexts> draw_texts_adder{};
 
-void DrawTexts::_run(const SessionWrapper& session, const WorldWrapper& world) const {
+static void buildGlyphRun(std::string_view text,
+                          const Tileset& font,
+                          std::vector<Vertex>& vertices,
+                          std::vector<unsigned int>& indices) {
+  static const Vec2f corners[] = {Vec2f(-0.5f, 0.5f), Vec2f(0.5f, 0.5f), Vec2f(-0.5f, -0.5f),
+                                  Vec2f(0.5f, -0.5f)};
+  static const unsigned int quad_indices[] = {0, 1, 2, 1, 2, 3};
+
+  vertices.reserve(text.size() * 4);
+  indices.reserve(text.size() * 6);
+  for (size_t i = 0; i < text.size(); ++i) {
+    const Vec4f uv_rect = font.genTransform(static_cast<unsigned char>(text[i]));
+    const unsigned int first_vertex = static_cast<unsigned int>(vertices.size());
+
+    for (const Vec2f& corner : corners) {
+      Vertex& vertex = vertices.emplace_back();
+      vertex.position = Vec4f(corner.x() + static_cast<float>(i), corner.y(), 0.f, 0.f);
+      vertex.normal = Vec4f(0.f, 0.f, 1.f, 0.f);
+      vertex.tangent = Vec4f(1.f, 0.f, 0.f, 0.f);
+      vertex.color = Vec4f::ones();
+      vertex.uv0 = Vec2f(uv_rect.x() + ((corner.x() + 0.5f) * uv_rect.z()),
+                         uv_rect.y() + ((0.5f - corner.y()) * uv_rect.w()));
+      vertex.uv1 = vertex.uv0;
+    }
+
+    for (const unsigned int index : quad_indices) {
+      indices.push_back(first_vertex + index);
+    }
+  }
+}
+
+void DrawTexts::_run(const SessionWrapper& session,
+                     const WorldWrapper& world,
+                     GlyphRuns& glyph_runs) const {
   Renderer& renderer = session.renderer();
   Resources& resources = session.resources();
-  GUID shader = renderer.getDefaultShader()->guid();
-  GUID mesh = renderer.getUnitSquare()->guid();
+
+  for (auto& [_, glyph_run] : glyph_runs) {
+    glyph_run.used = false;
+  }
 
   for (const auto& [transform, text] : world.getComponents<const Transform2D, const Text>()) {
-    const auto text_opt = resources.getOrCreate<TextResource>(text->text);
-    const auto font_opt = resources.getOrCreate<TilesetResource>(text->font);
-    if (text_opt.has_value() && font_opt.has_value()) {
-      int i = 0;
-      Mat4f origin_model = Mat4f::scale(Vec3f(text->font_size, 1.0f)) * transform->matrix3D();
-      for (const char c : text_opt.value().get().constText()) {
-        renderer.submit(
-            text->camera_mask, GUID::null,
-            {ShaderInput("colour", Vec4f(1.f, 1.f, 1.f, 1.f)),
-             ShaderInput("tex", TextureRef(text->font, c))},
-            mesh, origin_model * Mat4f::translation(Vec3f(static_cast<float>(i++), 0.f, 0.f)));
+    auto it = glyph_runs.find({text->text, text->font});
+
+    // each distinct text and font pair is checked against its resources once per frame
+    if ((it == glyph_runs.end()) || !it->second.used) {
+      const auto text_opt = resources.getOrCreate<TextResource>(text->text);
+      const auto font_opt = resources.getOrCreate<TilesetResource>(text->font);
+      if (!text_opt.has_value() || !font_opt.has_value()) {
+        continue;
+      }
+
+      const TextResource& text_res = text_opt.value();
+      const TilesetResource& font_res = font_opt.value();
+      const auto texture_opt =
+          resources.getOrCreate<TexturePropsResource>(font_res.getTextureProps());
+      const uint64_t texture_gen = texture_opt.has_value() ? texture_opt.value().get().gen() : 0;
+
+      if (it == glyph_runs.end()) {
+        it = glyph_runs
+                 .emplace(std::pair(text->text, text->font),
+                          GlyphRun{std::numeric_limits<uint64_t>::max(), 0, 0, GUID::gen(),
+                                   nullptr, false})
+                 .first;
       }
+
+      GlyphRun& glyph_run = it->second;
+      if ((text_res.gen() != glyph_run.text_gen) || (font_res.gen() != glyph_run.font_gen) ||
+          (texture_gen != glyph_run.texture_gen)) {
+        Tileset font(text->font);
+        font.update(resources);
+
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        buildGlyphRun(text_res.constText(), font, vertices, indices);
+        renderer.submitMeshUpdate(glyph_run.mesh, std::move(vertices), std::move(indices));
+
+        glyph_run.inputs =
+            ShaderInputBlock::intern({ShaderInput("colour", Vec4f(1.f, 1.f, 1.f, 1.f)),
+                                      ShaderInput("tex", TextureRef(font.getTextureProps()))});
+        glyph_run.text_gen = text_res.gen();
+        glyph_run.font_gen = font_res.gen();
+        glyph_run.texture_gen = texture_gen;
+      }
+      glyph_run.used = true;
     }
+
+    const Mat4f model = Mat4f::scale(Vec3f(text->font_size, 1.0f)) * transform->matrix3D();
+    renderer.submit(text->camera_mask, GUID::null, it->second.inputs, it->second.mesh, model);
+  }
+
+  std::erase_if(glyph_runs, [&renderer](const auto& pair) {
+    if (!pair.second.used) {
+      renderer.submitMeshRelease(pair.second.mesh);
+    }
+    return !pair.second.used;
+  });
+}
+
+void DrawTexts::_releaseCache(Session& session, GlyphRuns& glyph_runs) const {
+  Renderer& renderer = session.renderer();
+  for (const auto& [_, glyph_run] : glyph_runs) {
+    renderer.submitMeshRelease(glyph_run.mesh);
   }
 }
 
@@ -54,7 +138,7 @@ SystemId DrawTexts::id() const {
 }
 
 const SessionAccess& DrawTexts::getSessionAccess() const {
-  static const SessionAccess session_access = SessionAccess().addRenderer().addResources();
+  static const SessionAccess session_access = SessionAccess().addRendererSubmit().addResources();
   return session_access;
 }
 
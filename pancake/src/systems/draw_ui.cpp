@@ -11,6 +11,7 @@
 #include "graphics/mesh.hpp"
 #include "graphics/shader.hpp"
 #include "graphics/shader_input.hpp"
+#include "graphics/shader_input_block.hpp"
 #include "graphics/texture.hpp"
 #include "resources/tileset_resource.hpp"
 #include "util/fewi.hpp"
@@ -24,23 +25,17 @@ void recursor(const Entity& ent,
               const GUID& framebuffer,
               const WorldWrapper& world,
               const Mat4f& projection_view,
-              const GUID& mesh,
-              const GUID& shader,
-              Renderer& renderer,
-              Resources& resources) {
+              std::vector<UIDraw>& draws) {
   EntityWrapper entity = world.getEntityWrapper(ent);
 
-  CommonPerInstanceData cpid;
   if (entity.hasComponent<UIBackground>()) {
     const UIBackground& bg = entity.getComponent<const UIBackground>();
-    cpid.mvp_transform =
+    draws.emplace_back(
+        framebuffer, std::set{ShaderInput("colour", bg.colour), ShaderInput("tex", TextureRef())},
         projection_view *
-        Mat4f::translation(ui.absolute_position.x() + (ui.absolute_size.x() * 0.5f),
-                           ui.absolute_position.y() + (ui.absolute_size.y() * 0.5f), 0.f) *
-        Mat4f::scale(ui.absolute_size.x(), -ui.absolute_size.y(), 1.f);
-    renderer.submit(1000, framebuffer, {}, shader,
-                    {ShaderInput("colour", bg.colour), ShaderInput("tex", TextureRef())}, mesh,
-                    cpid);
+            Mat4f::translation(ui.absolute_position.x() + (ui.absolute_size.x() * 0.5f),
+                               ui.absolute_position.y() + (ui.absolute_size.y() * 0.5f), 0.f) *
+            Mat4f::scale(ui.absolute_size.x(), -ui.absolute_size.y(), 1.f));
   }
 
   if (entity.hasComponents<UIText, UIString>()) {
@@ -75,25 +70,24 @@ void recursor(const Entity& ent,
       }
 
       Vec2f absolute_position = ui.absolute_position + position;
-      cpid.mvp_transform = projection_view * Mat4f::translation(Vec3f(absolute_position, 0.f)) *
-                           Mat4f::scale(text.font_size.x(), -text.font_size.y(), 1.f);
-      renderer.submit(1000, framebuffer, {}, shader,
-                      {ShaderInput("colour", Vec4f(1.f, 0.f, 0.f, 1.f)),
-                       ShaderInput("tex", TextureRef(text.font, c))},
-                      mesh, cpid);
+      draws.emplace_back(framebuffer,
+                         std::set{ShaderInput("colour", Vec4f(1.f, 0.f, 0.f, 1.f)),
+                                  ShaderInput("tex", TextureRef(text.font, c))},
+                         projection_view * Mat4f::translation(Vec3f(absolute_position, 0.f)) *
+                             Mat4f::scale(text.font_size.x(), -text.font_size.y(), 1.f));
     }
   }
 
   for (const auto& [child_base, child_ui] :
        world.getChildrenComponents<const Base, const UIContainer>(ent)) {
-    recursor(child_base->self, *child_ui, framebuffer, world, projection_view, mesh, shader,
-             renderer, resources);
+    recursor(child_base->self, *child_ui, framebuffer, world, projection_view, draws);
   }
 }
 
-void DrawUI::_run(const SessionWrapper& session, const WorldWrapper& world) const {
+void DrawUI::_run(const SessionWrapper& session,
+                  const WorldWrapper& world,
+                  RetainedUIDraws& retained) const {
   Renderer& renderer = session.renderer();
-  Resources& resources = session.resources();
   GUID shader = renderer.getDefaultShader()->guid();
   GUID mesh = renderer.getUnitSquare()->guid();
 
@@ -103,6 +97,7 @@ void DrawUI::_run(const SessionWrapper& session, const WorldWrapper& world) cons
   };
 
   const Mat4f default_projection_view = gen_projection_view(renderer.renderSize());
+  std::vector<UIDraw> draws;
   for (const auto& [base, ui] : world.getComponents<const Base, const UIContainer>()) {
     if (const auto ui_parent_opt =
             world.getEntityWrapper(base->parent).getArchetypeParent<UIContainer>();
@@ -117,11 +112,38 @@ void DrawUI::_run(const SessionWrapper& session, const WorldWrapper& world) cons
         fb_info_opt.has_value()) {
       const auto& [fb_base, fb_info] = fb_info_opt.value();
       framebuffer = fb_base->guid;
-      projection_view = gen_projection_view(fb_info->size);
+      projection_view = gen_projection_view(renderer.layoutSize(*fb_info));
     }
 
-    recursor(base->self, *ui, framebuffer, world, projection_view, mesh, shader, renderer,
-             resources);
+    recursor(base->self, *ui, framebuffer, world, projection_view, draws);
+  }
+
+  // draws are retained by the renderer, so an unchanged ui submits nothing
+  for (size_t i = 0; i < draws.size(); ++i) {
+    if (i == retained.ids.size()) {
+      retained.ids.push_back(GUID::gen());
+    } else if ((i < retained.draws.size()) && (draws[i] == retained.draws[i])) {
+      continue;
+    }
+
+    const UIDraw& draw = draws[i];
+    CommonPerInstanceData cpid;
+    cpid.mvp_transform = draw.mvp;
+    renderer.submitRetained(retained.ids[i], 1000, draw.framebuffer, DrawOptions(), shader,
+                            ShaderInputBlock::intern(draw.inputs), mesh, cpid);
+  }
+
+  for (size_t i = draws.size(); i < retained.ids.size(); ++i) {
+    renderer.submitRetainedRelease(retained.ids[i]);
+  }
+  retained.ids.resize(draws.size());
+  retained.draws = std::move(draws);
+}
+
+void DrawUI::_releaseCache(Session& session, RetainedUIDraws& retained) const {
+  Renderer& renderer = session.renderer();
+  for (const GUID& id : retained.ids) {
+    renderer.submitRetainedRelease(id);
   }
 }
 
@@ -134,7 +156,7 @@ SystemId DrawUI::id() const {
 }
 
 const SessionAccess& DrawUI::getSessionAccess() const {
-  static const SessionAccess session_access = SessionAccess().addRenderer().addResources();
+  static const SessionAccess session_access = SessionAccess().addRendererSubmit().addResources();
   return session_access;
 }
 
@@ -85,7 +85,7 @@ void PropagateUI::_run(const SessionWrapper& session, const WorldWrapper& world)
           fb_info_opt.has_value()) {
         const auto& [fb_info] = fb_info_opt.value();
         frame_ui.absolute_position = Vec2f::zeros();
-        frame_ui.absolute_size = fb_info->size;
+        frame_ui.absolute_size = session.renderer().layoutSize(*fb_info);
       }
 
       recursor(0, *root_ui, root_base->self, frame_ui, world);
@@ -14,7 +14,7 @@ const DrawSystem::StaticAdder<SubmitFramebuffers> submit_framebuffers_adder{};
 
 void SubmitFramebuffers::_run(const SessionWrapper& session, const WorldWrapper& world) const {
   Renderer& renderer = session.renderer();
-  const Vec2f render_size = renderer.renderSize();
+  const Vec2f render_size = renderer.scaledRenderSize();
   for (const auto& [base, fb_info] : world.getComponents<const Base, FramebufferInfo>()) {
     if ((0 < fb_info->relative_size.x()) || (0 < fb_info->relative_size.y())) {
       fb_info->size = render_size.mask(fb_info->relative_size);
@@ -14,7 +14,8 @@
 
 using namespace pancake;
 
-GltfImporter::GltfImporter(const GUID& base_material) : _base_material(base_material) {}
+GltfImporter::GltfImporter(const GUID& base_material, bool mark_static)
+    : _base_material(base_material), _mark_static(mark_static) {}
 
 void GltfImporter::import(World& world, Resources& resources, const GltfResource& gltf) const {
   const auto& model = gltf.getModel();
@@ -86,6 +87,10 @@ bool GltfImporter::importNode(const EntityWrapper& entity,
         MeshInstance& mesh_inst = mesh_entity.addComponent<MeshInstance>();
         mesh_inst.mesh = gltf_prim.guid();
 
+        if (_mark_static) {
+          mesh_entity.addComponent<StaticMesh>();
+        }
+
         MaterialInstance& mat_inst = mesh_entity.addComponent<MaterialInstance>();
         mat_inst.material = _base_material;
 
@@ -103,6 +108,11 @@ bool GltfImporter::importNode(const EntityWrapper& entity,
             material_res.setShader(base_material_res.getShader());
             material_res.setStage(base_material_res.getStage());
             material_res.setDepthTest(base_material_res.getDepthTest());
+            // blending is always on, so anything but full alpha shows what is behind it
+            const bool opaque_alpha =
+                (material.alphaMode.empty() || ("OPAQUE" == material.alphaMode)) &&
+                (1.0 <= material.pbrMetallicRoughness.baseColorFactor[3]);
+            material_res.setOpaque(base_material_res.getOpaque() && opaque_alpha);
             material_res.setLightPassInputName(base_material_res.getLightPassInputName());
             material_res.setViewInputName(base_material_res.getViewInputName());
             for (const ShaderInput& input : base_material_res.getInputs()) {
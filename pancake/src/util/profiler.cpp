@@ -0,0 +1,121 @@
+#include "util/profiler.hpp"
+
+#if defined(PANCAKE_ENABLE_IMGUI)
+#include "imgui/imgui.h"
+#endif
+
+#include <algorithm>
+
+namespace chrono = std::chrono;
+
+using namespace pancake;
+
+// weight of each new sample in the running average
+static const double AVERAGE_WEIGHT = 0.05;
+
+// timings not recorded for this many frames are assumed gone, e.g. a framebuffer pass culled
+static const uint64_t STALE_FRAMES = 120;
+
+Profiler::Scope::Scope(std::string_view name)
+    : _name(name), _start(chrono::high_resolution_clock::now()) {}
+
+Profiler::Scope::~Scope() {
+  const chrono::duration<double, std::milli> duration =
+      chrono::high_resolution_clock::now() - _start;
+  Profiler::get().record(_name, Source::CPU, duration.count());
+}
+
+Profiler::Profiler() : _mutex(), _timings(), _frame(0) {}
+
+Profiler& Profiler::get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::record(std::string_view name,
+                      Source source,
+                      double milliseconds,
+                      std::optional<uint64_t> sample) {
+  std::scoped_lock lock(_mutex);
+
+  const uint64_t sample_id = sample.value_or(_frame);
+
+  auto it = std::find_if(_timings.begin(), _timings.end(), [&](const Timing& timing) {
+    return (timing.source == source) && (timing.name == name);
+  });
+  if (it == _timings.end()) {
+    _timings.emplace_back(std::string(name), source, milliseconds, milliseconds, _frame,
+                          sample_id);
+    return;
+  }
+
+  // repeated timings within a sample accumulate
+  if (it->sample == sample_id) {
+    it->average += (milliseconds * AVERAGE_WEIGHT);
+    it->last += milliseconds;
+  } else {
+    it->average += ((milliseconds - it->average) * AVERAGE_WEIGHT);
+    it->last = milliseconds;
+    it->sample = sample_id;
+  }
+  it->frame = _frame;
+}
+
+void Profiler::endFrame() {
+  std::scoped_lock lock(_mutex);
+
+  std::erase_if(_timings,
+                [&](const Timing& timing) { return (timing.frame + STALE_FRAMES) < _frame; });
+  ++_frame;
+}
+
+std::vector<Profiler::Timing> Profiler::timings() const {
+  std::scoped_lock lock(_mutex);
+  return _timings;
+}
+
+double Profiler::average(std::string_view name, Source source) const {
+  std::scoped_lock lock(_mutex);
+
+  for (const Timing& timing : _timings) {
+    if ((timing.source == source) && (timing.name == name)) {
+      return timing.average;
+    }
+  }
+  return 0.0;
+}
+
+#if defined(PANCAKE_ENABLE_IMGUI)
+void Profiler::showWindow() const {
+  const std::vector<Timing> timings = this->timings();
+  const double cpu_frame = average(CPU_FRAME, Source::CPU);
+  const double gpu_frame = average(GPU_FRAME, Source::GPU);
+
+  if (ImGui::Begin("Profiler")) {
+    ImGui::Text("cpu %.3f ms, gpu %.3f ms : %s bound", cpu_frame, gpu_frame,
+                (gpu_frame > cpu_frame) ? "gpu" : "cpu");
+
+    if (ImGui::BeginTable("timings", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+      ImGui::TableSetupColumn("name");
+      ImGui::TableSetupColumn("source");
+      ImGui::TableSetupColumn("last (ms)");
+      ImGui::TableSetupColumn("average (ms)");
+      ImGui::TableHeadersRow();
+
+      for (const Timing& timing : timings) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(timing.name.c_str());
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted((Source::CPU == timing.source) ? "cpu" : "gpu");
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", timing.last);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", timing.average);
+      }
+      ImGui::EndTable();
+    }
+  }
+  ImGui::End();
+}
+#endif
\ No newline at end of file